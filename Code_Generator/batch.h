@@ -0,0 +1,141 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "instruction.h"
+#include "vm.h"
+
+// Evaluates one program over many rows of columnar data. Instead of
+// interpreting the program once per row, each instruction runs over a
+// block of BLOCK_ROWS rows, so dispatch is paid once per block and every
+// operation is a plain loop over arrays that the compiler vectorizes
+// (build with -O3, plus -mavx2 for 4 doubles per instruction).
+//
+// Stack entries are views: a pushed variable points into its column and a
+// pushed constant stays a scalar, so pushes copy nothing; an operation
+// writes into the block buffer of its stack slot. Operations on two
+// constants fold to a constant.
+class BatchVM {
+public:
+    static constexpr size_t BLOCK_ROWS = 1024;
+
+private:
+    // One stack entry: BLOCK_ROWS values at data, or scalar when data is null
+    struct Entry {
+        const double* data;
+        double scalar;
+    };
+
+    const Program* program = nullptr;
+    std::vector<Entry> stack;
+    std::vector<double> blocks;      // one BLOCK_ROWS buffer per stack slot
+
+    template <typename Op>
+    static void vectorVector(double* out, const double* x, const double* y, size_t n, Op op) {
+        for (size_t i = 0; i < n; i++) out[i] = op(x[i], y[i]);
+    }
+
+    template <typename Op>
+    static void vectorScalar(double* out, const double* x, double y, size_t n, Op op) {
+        for (size_t i = 0; i < n; i++) out[i] = op(x[i], y);
+    }
+
+    template <typename Op>
+    static void scalarVector(double* out, double x, const double* y, size_t n, Op op) {
+        for (size_t i = 0; i < n; i++) out[i] = op(x, y[i]);
+    }
+
+    // Replace the top two entries with x op y; slot is x's stack index and
+    // a vector result goes to out, or to the slot's block if out is null
+    template <typename Op>
+    void apply(size_t slot, size_t n, double* out, Op op) {
+        Entry& x = stack[slot];
+        const Entry& y = stack[slot + 1];
+        if (!x.data && !y.data) {
+            x.scalar = op(x.scalar, y.scalar);
+            return;
+        }
+        if (!out) out = &blocks[slot * BLOCK_ROWS];
+        if (x.data && y.data) {
+            vectorVector(out, x.data, y.data, n, op);
+        } else if (x.data) {
+            vectorScalar(out, x.data, y.scalar, n, op);
+        } else {
+            scalarVector(out, x.scalar, y.data, n, op);
+        }
+        x.data = out;
+    }
+
+    // Run the program over rows [row, row + n) into out; the last
+    // operation writes its result there directly
+    void runBlock(const double* const* columns, size_t row, size_t n, double* out) {
+        const Instruction* last = &program->code.back();
+        size_t sp = 0;
+        for (const Instruction& instruction : program->code) {
+            double* target = &instruction == last ? out : nullptr;
+            switch (instruction.op) {
+                case Opcode::PushVar:
+                    stack[sp++] = { columns[instruction.operand] + row, 0 };
+                    break;
+                case Opcode::PushConst:
+                    stack[sp++] = { nullptr, program->values[instruction.operand] };
+                    break;
+                case Opcode::Add:
+                    sp--;
+                    apply(sp - 1, n, target, [](double a, double b) { return a + b; });
+                    break;
+                case Opcode::Sub:
+                    sp--;
+                    apply(sp - 1, n, target, [](double a, double b) { return a - b; });
+                    break;
+                case Opcode::Mul:
+                    sp--;
+                    apply(sp - 1, n, target, [](double a, double b) { return a * b; });
+                    break;
+                case Opcode::Div:
+                    sp--;
+                    apply(sp - 1, n, target, [](double a, double b) { return a / b; });
+                    break;
+            }
+        }
+        if (!stack[0].data) {
+            std::fill(out, out + n, stack[0].scalar);
+        } else if (stack[0].data != out) {
+            std::copy(stack[0].data, stack[0].data + n, out);
+        }
+    }
+
+public:
+    // Check program (as StackVM::load does, without a depth limit) and
+    // allocate its stack blocks; returns false if it is malformed, and
+    // leaves the VM unloaded. The program must outlive the VM's use of it.
+    bool load(const Program& code) {
+        program = nullptr;
+        stack.clear();
+        blocks.clear();
+        size_t depth = stackDepth(code);
+        if (depth == 0) return false;
+        program = &code;
+        stack.assign(depth, Entry{ nullptr, 0 });
+        blocks.assign(depth * BLOCK_ROWS, 0);
+        return true;
+    }
+
+    // Evaluate the loaded program for rows rows: columns[i] holds the
+    // values of variable pool entry i, one per row; out receives one
+    // result per row (NaN if no program is loaded)
+    void run(const double* const* columns, size_t rows, double* out) {
+        if (!program) {
+            std::fill(out, out + rows, NAN);
+            return;
+        }
+        for (size_t row = 0; row < rows; row += BLOCK_ROWS) {
+            runBlock(columns, row, std::min(BLOCK_ROWS, rows - row), out + row);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,220 @@
+// Benchmark: packed instructions vs. the previous vector<string> assembly
+//
+//   g++ -std=c++17 -O2 bench_encoding.cpp -o bench_encoding
+//   ./bench_encoding [megabytes]
+//
+// Both encodings are generated from the same postfix tokens of a random
+// expression of the given size, once with nearly all operands distinct
+// (the worst case for interning) and once with a 512-symbol vocabulary.
+// "Codegen" is the time to emit the code, "bytes" the memory it occupies
+// (string objects and their heap buffers, or instructions plus the
+// interned pools), and "dispatch" the cost per instruction of a pass that
+// classifies every instruction and tracks the stack depth, the work any
+// consumer does before it can execute anything.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "code_generator.h"
+
+using namespace std;
+
+static double seconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Previous encoding: one "PUSH x" / "ADD" string per instruction
+static vector<string> generateText(const vector<Token>& postfix) {
+    vector<string> assemblyCode;
+    for (const Token& token : postfix) {
+        if (token.type == TokenType::Operator) {
+            switch (token.text[0]) {
+                case '+': assemblyCode.push_back("ADD"); break;
+                case '-': assemblyCode.push_back("SUB"); break;
+                case '*': assemblyCode.push_back("MUL"); break;
+                default: assemblyCode.push_back("DIV"); break;
+            }
+        } else {
+            string instruction = "PUSH ";
+            instruction += token.text;
+            assemblyCode.push_back(instruction);
+        }
+    }
+    return assemblyCode;
+}
+
+static size_t textBytes(const vector<string>& assemblyCode) {
+    size_t bytes = assemblyCode.capacity() * sizeof(string);
+    for (const string& line : assemblyCode) {
+        // Short strings live inside the object; longer ones own a buffer
+        if (line.capacity() > 15) bytes += line.capacity() + 1;
+    }
+    return bytes;
+}
+
+static size_t packedBytes(const Program& program) {
+    size_t bytes = program.code.capacity() * sizeof(Instruction) + program.values.capacity() * sizeof(double);
+    // Each pooled string: its text, an offset, a hash and about two slots
+    size_t pooled = program.variables.size() + program.constants.size();
+    bytes += pooled * 4 * sizeof(uint32_t);
+    for (uint32_t i = 0; i < program.variables.size(); i++) bytes += program.variables.text(i).size();
+    for (uint32_t i = 0; i < program.constants.size(); i++) bytes += program.constants.text(i).size();
+    return bytes;
+}
+
+// Maximum stack depth, decoding each instruction the way simulate() did
+static int depthText(const vector<string>& assemblyCode) {
+    int depth = 0, maxDepth = 0;
+    for (const string& instruction : assemblyCode) {
+        if (instruction.substr(0, 4) == "PUSH") {
+            depth++;
+            if (depth > maxDepth) maxDepth = depth;
+        } else if (instruction.substr(0, 3) == "ADD" || instruction.substr(0, 3) == "SUB" ||
+                   instruction.substr(0, 3) == "MUL" || instruction.substr(0, 3) == "DIV") {
+            depth--;
+        }
+    }
+    return maxDepth;
+}
+
+static int depthPacked(const vector<Instruction>& code) {
+    int depth = 0, maxDepth = 0;
+    for (const Instruction& instruction : code) {
+        switch (instruction.op) {
+            case Opcode::PushVar:
+            case Opcode::PushConst:
+                depth++;
+                if (depth > maxDepth) maxDepth = depth;
+                break;
+            case Opcode::Add:
+            case Opcode::Sub:
+            case Opcode::Mul:
+            case Opcode::Div:
+                depth--;
+                break;
+        }
+    }
+    return maxDepth;
+}
+
+// Append one random operand. With a vocabulary, it is one of that many
+// variables or as many constants; otherwise nearly every operand is
+// distinct (as in bench_tokenizer).
+static void randomOperand(string& expr, int vocabulary, mt19937& rng) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz_";
+    if (vocabulary) {
+        expr += rng() % 2 ? "x" : "1.";
+        expr += to_string(rng() % vocabulary);
+        return;
+    }
+    switch (rng() % 3) {
+        case 0: {
+            int len = 1 + rng() % 8;
+            for (int i = 0; i < len; i++) expr += letters[rng() % 27];
+            break;
+        }
+        case 1:
+            expr += to_string(rng() % 100000);
+            break;
+        default:
+            expr += to_string(rng() % 1000);
+            expr += '.';
+            expr += to_string(rng() % 1000);
+            if (rng() % 4 == 0) expr += "e-3";
+            break;
+    }
+}
+
+// Random expression of at least size bytes
+static string randomExpression(size_t size, int vocabulary, mt19937& rng) {
+    static const char ops[] = "+-*/";
+    string expr;
+    expr.reserve(size + 64);
+    int depth = 0;
+
+    while (expr.size() < size || depth > 0) {
+        while (expr.size() < size && rng() % 4 == 0) {
+            expr += '(';
+            depth++;
+        }
+        randomOperand(expr, vocabulary, rng);
+        while (depth > 0 && (expr.size() >= size || rng() % 4 == 0)) {
+            expr += ')';
+            depth--;
+        }
+        if (expr.size() < size || depth > 0) {
+            expr += ' ';
+            expr += ops[rng() % 4];
+            expr += ' ';
+        }
+    }
+    return expr;
+}
+
+// Generate, measure and print one row per encoding for expr
+static bool compare(const string& expr) {
+    CodeGenerator generator;
+    vector<Token> postfix = generator.infixToPostfix(expr);
+
+    double codegen[2] = { 1e30, 1e30 };
+    double dispatch[2] = { 1e30, 1e30 };
+    size_t bytes[2] = { 0, 0 };
+    int depth[2] = { 0, 0 };
+
+    for (int run = 0; run < 3; run++) {
+        double start = seconds();
+        vector<string> text = generateText(postfix);
+        double elapsed = seconds() - start;
+        if (elapsed < codegen[0]) codegen[0] = elapsed;
+        bytes[0] = textBytes(text);
+
+        start = seconds();
+        depth[0] = depthText(text);
+        elapsed = seconds() - start;
+        if (elapsed < dispatch[0]) dispatch[0] = elapsed;
+
+        CodeGenerator packed;
+        start = seconds();
+        packed.generateFromPostfix(postfix);
+        elapsed = seconds() - start;
+        if (elapsed < codegen[1]) codegen[1] = elapsed;
+        bytes[1] = packedBytes(packed.getProgram());
+
+        start = seconds();
+        depth[1] = depthPacked(packed.getInstructions());
+        elapsed = seconds() - start;
+        if (elapsed < dispatch[1]) dispatch[1] = elapsed;
+    }
+
+    if (depth[0] != depth[1]) {
+        fprintf(stderr, "Error: encodings disagree on the stack depth (%d vs %d)\n", depth[0], depth[1]);
+        return false;
+    }
+
+    generator.generateFromPostfix(postfix);
+    const Program& program = generator.getProgram();
+    size_t count = program.code.size();
+    printf("\nExpression: %.1f MB, %zu instructions, %zu variables, %zu constants\n",
+           expr.size() / 1048576.0, count, program.variables.size(), program.constants.size());
+    printf("%-16s %12s %12s %14s %14s\n", "Encoding", "codegen ms", "MB", "bytes/instr", "dispatch ns");
+    const char* names[2] = { "vector<string>", "packed" };
+    for (int side = 0; side < 2; side++) {
+        printf("%-16s %12.1f %12.1f %14.1f %14.2f\n", names[side], codegen[side] * 1e3,
+               bytes[side] / 1048576.0, (double)bytes[side] / count, dispatch[side] * 1e9 / count);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 16;
+    mt19937 rng(12345);
+
+    // Distinct operands: worst case for interning
+    if (!compare(randomExpression(megabytes << 20, 0, rng))) return EXIT_FAILURE;
+    // 256 variables and 256 constants, as in a real formula
+    if (!compare(randomExpression(megabytes << 20, 256, rng))) return EXIT_FAILURE;
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Benchmark: zero-copy tokenizer vs. the previous char-at-a-time front end
+//
+//   g++ -std=c++17 -O2 bench_tokenizer.cpp -o bench_tokenizer
+//   ./bench_tokenizer [megabytes]
+//
+// Both front ends take a random infix expression of the given size (multi-
+// character identifiers, integer and float literals, nested parentheses)
+// to the token sequence the code generator consumes. The previous one
+// builds a space-separated postfix string and splits it again through a
+// stringstream; the tokenizer goes straight to a vector of views into the
+// expression. Heap allocations are counted by replacing operator new.
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stack>
+#include <string>
+#include <vector>
+#include "code_generator.h"
+
+using namespace std;
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = malloc(size)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static double seconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Previous front end: every alphanumeric character is an operand
+namespace legacy {
+
+int getPrecedence(char op) {
+    if (op == '+' || op == '-') return 1;
+    if (op == '*' || op == '/') return 2;
+    return 0;
+}
+
+bool isOperator(char c) {
+    return (c == '+' || c == '-' || c == '*' || c == '/');
+}
+
+string infixToPostfix(const string& infix) {
+    stack<char> operators;
+    string postfix = "";
+
+    for (char c : infix) {
+        if (c == ' ') continue;
+        if (isalnum(c)) {
+            postfix += c;
+            postfix += ' ';
+        } else if (c == '(') {
+            operators.push(c);
+        } else if (c == ')') {
+            while (!operators.empty() && operators.top() != '(') {
+                postfix += operators.top();
+                postfix += ' ';
+                operators.pop();
+            }
+            if (!operators.empty()) operators.pop();
+        } else if (isOperator(c)) {
+            while (!operators.empty() && operators.top() != '(' &&
+                   getPrecedence(operators.top()) >= getPrecedence(c)) {
+                postfix += operators.top();
+                postfix += ' ';
+                operators.pop();
+            }
+            operators.push(c);
+        }
+    }
+
+    while (!operators.empty()) {
+        postfix += operators.top();
+        postfix += ' ';
+        operators.pop();
+    }
+
+    return postfix;
+}
+
+vector<string> tokenize(const string& postfix) {
+    vector<string> tokens;
+    stringstream ss(postfix);
+    string token;
+    while (ss >> token) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+} // namespace legacy
+
+// Random expression of at least size bytes
+static string randomExpression(size_t size, mt19937& rng) {
+    static const char ops[] = "+-*/";
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz_";
+    string expr;
+    expr.reserve(size + 64);
+    int depth = 0;
+
+    while (expr.size() < size || depth > 0) {
+        while (expr.size() < size && rng() % 4 == 0) {
+            expr += '(';
+            depth++;
+        }
+        switch (rng() % 3) {
+            case 0: {
+                int len = 1 + rng() % 8;
+                for (int i = 0; i < len; i++) expr += letters[rng() % 27];
+                break;
+            }
+            case 1:
+                expr += to_string(rng() % 100000);
+                break;
+            default:
+                expr += to_string(rng() % 1000);
+                expr += '.';
+                expr += to_string(rng() % 1000);
+                if (rng() % 4 == 0) expr += "e-3";
+                break;
+        }
+        while (depth > 0 && (expr.size() >= size || rng() % 4 == 0)) {
+            expr += ')';
+            depth--;
+        }
+        if (expr.size() < size || depth > 0) {
+            expr += ' ';
+            expr += ops[rng() % 4];
+            expr += ' ';
+        }
+    }
+    return expr;
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 16;
+    mt19937 rng(12345);
+    string expr = randomExpression(megabytes << 20, rng);
+    double mb = expr.size() / 1048576.0;
+
+    CodeGenerator generator;
+    double best[2] = { 1e30, 1e30 };
+    size_t tokens[2] = { 0, 0 };
+    size_t allocs[2] = { 0, 0 };
+
+    for (int run = 0; run < 3; run++) {
+        size_t before = allocations;
+        double start = seconds();
+        vector<string> split = legacy::tokenize(legacy::infixToPostfix(expr));
+        double elapsed = seconds() - start;
+        allocs[0] = allocations - before;
+        tokens[0] = split.size();
+        if (elapsed < best[0]) best[0] = elapsed;
+
+        before = allocations;
+        start = seconds();
+        vector<Token> postfix = generator.infixToPostfix(expr);
+        elapsed = seconds() - start;
+        allocs[1] = allocations - before;
+        tokens[1] = postfix.size();
+        if (elapsed < best[1]) best[1] = elapsed;
+    }
+
+    printf("Expression: %.1f MB\n\n", mb);
+    printf("%-30s %10s %10s %12s %12s\n", "Front end", "ms", "MB/s", "Mtokens/s", "allocs");
+    const char* names[2] = { "char-at-a-time + stringstream", "zero-copy tokenizer" };
+    for (int side = 0; side < 2; side++) {
+        printf("%-30s %10.1f %10.1f %12.1f %12zu\n", names[side], best[side] * 1e3,
+               mb / best[side], tokens[side] / best[side] / 1e6, allocs[side]);
+    }
+    printf("\n(the previous front end splits every multi-character operand into one\n"
+           " token per character: %zu tokens vs %zu)\n", tokens[0], tokens[1]);
+    return 0;
+}
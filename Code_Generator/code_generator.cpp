@@ -1,201 +1,12 @@
 #include <iostream>
 #include <string>
-#include <stack>
+#include <unordered_map>
 #include <vector>
-#include <cctype>
-#include <sstream>
+#include "code_generator.h"
+#include "jit.h"
 
 using namespace std;
 
-class CodeGenerator {
-private:
-    vector<string> assemblyCode;
-    
-    // Check if character is an operator
-    bool isOperator(char c) {
-        return (c == '+' || c == '-' || c == '*' || c == '/');
-    }
-    
-    // Get operator precedence
-    int getPrecedence(char op) {
-        if (op == '+' || op == '-') return 1;
-        if (op == '*' || op == '/') return 2;
-        return 0;
-    }
-    
-    // Convert infix expression to postfix (Reverse Polish Notation)
-    string infixToPostfix(const string& infix) {
-        stack<char> operators;
-        string postfix = "";
-        
-        for (size_t i = 0; i < infix.length(); i++) {
-            char c = infix[i];
-            
-            // Skip whitespace
-            if (isspace(c)) continue;
-            
-            // If operand (variable or number), add to postfix
-            if (isalnum(c)) {
-                postfix += c;
-                postfix += ' ';
-            }
-            // If opening parenthesis, push to stack
-            else if (c == '(') {
-                operators.push(c);
-            }
-            // If closing parenthesis, pop until opening parenthesis
-            else if (c == ')') {
-                while (!operators.empty() && operators.top() != '(') {
-                    postfix += operators.top();
-                    postfix += ' ';
-                    operators.pop();
-                }
-                if (!operators.empty()) operators.pop(); // Remove '('
-            }
-            // If operator
-            else if (isOperator(c)) {
-                while (!operators.empty() && operators.top() != '(' &&
-                       getPrecedence(operators.top()) >= getPrecedence(c)) {
-                    postfix += operators.top();
-                    postfix += ' ';
-                    operators.pop();
-                }
-                operators.push(c);
-            }
-        }
-        
-        // Pop remaining operators
-        while (!operators.empty()) {
-            if (operators.top() != '(') {
-                postfix += operators.top();
-                postfix += ' ';
-            }
-            operators.pop();
-        }
-        
-        return postfix;
-    }
-    
-    // Get assembly instruction for operator
-    string getOperatorInstruction(char op) {
-        switch(op) {
-            case '+': return "ADD";
-            case '-': return "SUB";
-            case '*': return "MUL";
-            case '/': return "DIV";
-            default: return "";
-        }
-    }
-    
-    // Generate assembly code from postfix expression
-    void generateFromPostfix(const string& postfix) {
-        stringstream ss(postfix);
-        string token;
-        
-        while (ss >> token) {
-            if (token.length() == 1 && isOperator(token[0])) {
-                // It's an operator
-                string instruction = getOperatorInstruction(token[0]);
-                assemblyCode.push_back(instruction);
-            } else {
-                // It's an operand (variable or number)
-                assemblyCode.push_back("PUSH " + token);
-            }
-        }
-    }
-    
-public:
-    // Main function to generate code from infix expression
-    void generate(const string& expression) {
-        assemblyCode.clear();
-        
-        cout << "\n========================================\n";
-        cout << "Code Generation Process\n";
-        cout << "========================================\n";
-        
-        cout << "\nStep 1: Parse Infix Expression\n";
-        cout << "Input: " << expression << "\n";
-        
-        cout << "\nStep 2: Convert to Postfix (RPN)\n";
-        string postfix = infixToPostfix(expression);
-        cout << "Postfix: " << postfix << "\n";
-        
-        cout << "\nStep 3: Generate Assembly Code\n";
-        generateFromPostfix(postfix);
-        
-        cout << "Assembly instructions generated: " << assemblyCode.size() << "\n";
-    }
-    
-    // Print generated assembly code
-    void printAssembly() {
-        cout << "\n========================================\n";
-        cout << "Generated Assembly Code\n";
-        cout << "========================================\n";
-        
-        for (const auto& instruction : assemblyCode) {
-            cout << instruction << "\n";
-        }
-    }
-    
-    // Get assembly code as vector
-    vector<string> getAssemblyCode() {
-        return assemblyCode;
-    }
-    
-    // Simulate stack machine execution
-    void simulate() {
-        cout << "\n========================================\n";
-        cout << "Stack Machine Simulation\n";
-        cout << "========================================\n";
-        
-        stack<string> evalStack;
-        
-        cout << "\nExecution trace:\n";
-        cout << "Instruction         Stack (top->bottom)\n";
-        cout << "----------------    --------------------\n";
-        
-        for (const auto& instruction : assemblyCode) {
-            cout << instruction;
-            
-            // Pad instruction for alignment
-            for (int i = instruction.length(); i < 20; i++) {
-                cout << " ";
-            }
-            
-            if (instruction.substr(0, 4) == "PUSH") {
-                string operand = instruction.substr(5);
-                evalStack.push(operand);
-            } else {
-                // It's an operation
-                if (evalStack.size() >= 2) {
-                    string op2 = evalStack.top(); evalStack.pop();
-                    string op1 = evalStack.top(); evalStack.pop();
-                    string result = "(" + op1 + instruction.substr(0, 3) + op2 + ")";
-                    evalStack.push(result);
-                }
-            }
-            
-            // Print stack contents
-            stack<string> temp = evalStack;
-            vector<string> stackContents;
-            while (!temp.empty()) {
-                stackContents.push_back(temp.top());
-                temp.pop();
-            }
-            
-            for (const auto& item : stackContents) {
-                cout << item << " ";
-            }
-            cout << "\n";
-        }
-        
-        cout << "\nFinal result on stack: ";
-        if (!evalStack.empty()) {
-            cout << evalStack.top() << "\n";
-        }
-    }
-};
-
 int main() {
     CodeGenerator generator;
     
@@ -222,6 +33,26 @@ int main() {
     // Simulate execution
     generator.simulate();
     
+    // Execute on the numeric VM
+    unordered_map<string, double> bindings = { {"a", 2}, {"b", 3}, {"c", 4} };
+    cout << "\n========================================\n";
+    cout << "Numeric Evaluation (VM)\n";
+    cout << "========================================\n";
+    cout << "a = 2, b = 3, c = 4\n";
+    cout << "Result: " << generator.evaluate(bindings) << "\n";
+    
+    // Same evaluation through the JIT (interpreted where unsupported)
+    JitExpression jit;
+    if (jit.compile(generator.getProgram())) {
+        vector<double> values = bindVariables(generator.getProgram(), bindings);
+        cout << "JIT result: " << jit.run(values.data());
+        if (jit.native()) {
+            cout << " (native x86-64, " << jit.codeSize() << " bytes)\n";
+        } else {
+            cout << " (interpreted)\n";
+        }
+    }
+    
     cout << "\n========================================\n";
     cout << "Code Generation Complete!\n";
     cout << "========================================\n";
@@ -244,7 +75,9 @@ int main() {
         "a+b",
         "a*b+c",
         "(a+b)*(c+d)",
-        "a+b*c"
+        "a+b*c",
+        "alpha+12*(beta-3.5)",
+        "rate*1.5e-3/(x1+x2)"
     };
     
     for (const auto& expr : testCases) {
@@ -252,8 +85,9 @@ int main() {
         CodeGenerator gen;
         gen.generate(expr);
         cout << "Assembly:\n";
-        for (const auto& instr : gen.getAssemblyCode()) {
-            cout << "  " << instr << "\n";
+        const Program& program = gen.getProgram();
+        for (const Instruction& instr : program.code) {
+            cout << "  " << program.text(instr) << "\n";
         }
     }
     
@@ -0,0 +1,231 @@
+#ifndef CODE_GENERATOR_H
+#define CODE_GENERATOR_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <stack>
+#include <unordered_map>
+#include <vector>
+#include "instruction.h"
+#include "tokenizer.h"
+#include "vm.h"
+
+class CodeGenerator {
+private:
+    Program program;
+    
+    // Get operator precedence
+    int getPrecedence(char op) {
+        if (op == '+' || op == '-') return 1;
+        if (op == '*' || op == '/') return 2;
+        return 0;
+    }
+    
+    // Get opcode for operator
+    Opcode getOperatorOpcode(char op) {
+        switch(op) {
+            case '+': return Opcode::Add;
+            case '-': return Opcode::Sub;
+            case '*': return Opcode::Mul;
+            default: return Opcode::Div;
+        }
+    }
+    
+public:
+    // Convert infix expression to postfix (Reverse Polish Notation) with the
+    // shunting-yard algorithm. Tokens come straight from the tokenizer and
+    // are views into infix, so no token is copied and the result is only
+    // valid while infix is.
+    std::vector<Token> infixToPostfix(std::string_view infix) {
+        std::vector<Token> operators;
+        std::vector<Token> postfix;
+        Tokenizer tokenizer(infix);
+        
+        for (Token token = tokenizer.next(); token.type != TokenType::End; token = tokenizer.next()) {
+            // If operand (variable or number), add to postfix
+            if (token.isOperand()) {
+                postfix.push_back(token);
+            }
+            // If opening parenthesis, push to stack
+            else if (token.type == TokenType::LeftParen) {
+                operators.push_back(token);
+            }
+            // If closing parenthesis, pop until opening parenthesis
+            else if (token.type == TokenType::RightParen) {
+                while (!operators.empty() && operators.back().type != TokenType::LeftParen) {
+                    postfix.push_back(operators.back());
+                    operators.pop_back();
+                }
+                if (!operators.empty()) operators.pop_back(); // Remove '('
+            }
+            // If operator
+            else {
+                while (!operators.empty() && operators.back().type != TokenType::LeftParen &&
+                       getPrecedence(operators.back().text[0]) >= getPrecedence(token.text[0])) {
+                    postfix.push_back(operators.back());
+                    operators.pop_back();
+                }
+                operators.push_back(token);
+            }
+        }
+        
+        // Pop remaining operators
+        while (!operators.empty()) {
+            if (operators.back().type != TokenType::LeftParen) {
+                postfix.push_back(operators.back());
+            }
+            operators.pop_back();
+        }
+        
+        return postfix;
+    }
+    
+    // Postfix tokens as text, e.g. "a b + c * "
+    static std::string postfixText(const std::vector<Token>& postfix) {
+        std::string text;
+        for (const Token& token : postfix) {
+            text += token.text;
+            text += ' ';
+        }
+        return text;
+    }
+    
+    // Append packed instructions for postfix tokens; operands are interned
+    // into the program's variable and constant pools
+    void generateFromPostfix(const std::vector<Token>& postfix) {
+        program.code.reserve(program.code.size() + postfix.size());
+        for (const Token& token : postfix) {
+            if (token.type == TokenType::Operator) {
+                program.emit(getOperatorOpcode(token.text[0]));
+            } else if (token.type == TokenType::Identifier) {
+                program.pushVariable(token.text);
+            } else {
+                // It's a number (integer or float literal)
+                program.pushConstant(token.text);
+            }
+        }
+    }
+    
+    // Generate code from infix expression without any output
+    void compile(std::string_view expression) {
+        program.clear();
+        generateFromPostfix(infixToPostfix(expression));
+    }
+    
+    // Main function to generate code from infix expression
+    void generate(const std::string& expression) {
+        program.clear();
+        
+        std::cout << "\n========================================\n";
+        std::cout << "Code Generation Process\n";
+        std::cout << "========================================\n";
+        
+        std::cout << "\nStep 1: Parse Infix Expression\n";
+        std::cout << "Input: " << expression << "\n";
+        
+        std::cout << "\nStep 2: Convert to Postfix (RPN)\n";
+        std::vector<Token> postfix = infixToPostfix(expression);
+        std::cout << "Postfix: " << postfixText(postfix) << "\n";
+        
+        std::cout << "\nStep 3: Generate Assembly Code\n";
+        generateFromPostfix(postfix);
+        
+        std::cout << "Assembly instructions generated: " << program.code.size() << "\n";
+    }
+    
+    // Print generated assembly code
+    void printAssembly() {
+        std::cout << "\n========================================\n";
+        std::cout << "Generated Assembly Code\n";
+        std::cout << "========================================\n";
+        
+        for (const Instruction& instruction : program.code) {
+            std::cout << program.text(instruction) << "\n";
+        }
+    }
+    
+    // Generated program (instructions and operand pools)
+    const Program& getProgram() const {
+        return program;
+    }
+    
+    // Generated instructions
+    const std::vector<Instruction>& getInstructions() const {
+        return program.code;
+    }
+    
+    // Assembly code as text, one line per instruction
+    std::vector<std::string> getAssemblyText() const {
+        std::vector<std::string> lines;
+        lines.reserve(program.code.size());
+        for (const Instruction& instruction : program.code) {
+            lines.push_back(program.text(instruction));
+        }
+        return lines;
+    }
+    
+    // Evaluate generated code on the numeric stack VM; NaN if the code is
+    // malformed or a variable has no binding
+    double evaluate(const std::unordered_map<std::string, double>& bindings) const {
+        StackVM vm;
+        if (!vm.load(program)) return NAN;
+        std::vector<double> values = bindVariables(program, bindings);
+        return vm.run(values.data());
+    }
+    
+    // Symbolic stack machine execution trace
+    void simulate() {
+        std::cout << "\n========================================\n";
+        std::cout << "Stack Machine Simulation\n";
+        std::cout << "========================================\n";
+        
+        std::stack<std::string> evalStack;
+        
+        std::cout << "\nExecution trace:\n";
+        std::cout << "Instruction         Stack (top->bottom)\n";
+        std::cout << "----------------    --------------------\n";
+        
+        for (const Instruction& instruction : program.code) {
+            std::string text = program.text(instruction);
+            std::cout << text;
+            
+            // Pad instruction for alignment
+            for (int i = text.length(); i < 20; i++) {
+                std::cout << " ";
+            }
+            
+            if (instruction.op == Opcode::PushVar || instruction.op == Opcode::PushConst) {
+                evalStack.push(std::string(program.operandText(instruction)));
+            } else {
+                // It's an operation
+                if (evalStack.size() >= 2) {
+                    std::string op2 = evalStack.top(); evalStack.pop();
+                    std::string op1 = evalStack.top(); evalStack.pop();
+                    std::string result = "(" + op1 + Program::mnemonic(instruction.op) + op2 + ")";
+                    evalStack.push(result);
+                }
+            }
+            
+            // Print stack contents
+            std::stack<std::string> temp = evalStack;
+            std::vector<std::string> stackContents;
+            while (!temp.empty()) {
+                stackContents.push_back(temp.top());
+                temp.pop();
+            }
+            
+            for (const auto& item : stackContents) {
+                std::cout << item << " ";
+            }
+            std::cout << "\n";
+        }
+        
+        std::cout << "\nFinal result on stack: ";
+        if (!evalStack.empty()) {
+            std::cout << evalStack.top() << "\n";
+        }
+    }
+};
+
+#endif
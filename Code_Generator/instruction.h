@@ -0,0 +1,155 @@
+#ifndef INSTRUCTION_H
+#define INSTRUCTION_H
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Stack machine operations
+enum class Opcode : uint8_t {
+    PushVar,        // push the variable at operand
+    PushConst,      // push the constant at operand
+    Add,
+    Sub,
+    Mul,
+    Div
+};
+
+// One packed instruction: an opcode byte and, for pushes, an index into
+// the program's variable or constant pool (unused by the operations)
+struct Instruction {
+    Opcode op;
+    uint32_t operand;
+};
+
+// Interns strings: each distinct string is stored once and gets the next
+// index. The text of all strings shares one buffer, and lookups go through
+// an open-addressing table of indexes, so interning an operand that is
+// already known allocates nothing.
+class SymbolPool {
+private:
+    std::string chars;                   // all strings, back to back
+    std::vector<uint32_t> offsets;       // string i is chars[offsets[i], offsets[i + 1])
+    std::vector<uint32_t> hashes;        // hash of each string
+    std::vector<uint32_t> slots;         // index + 1 of the string in each slot, 0 if empty
+
+    static uint32_t hash(std::string_view text) {
+        uint32_t h = 2166136261u;   // FNV-1a
+        for (char c : text) {
+            h = (h ^ (unsigned char)c) * 16777619u;
+        }
+        return h;
+    }
+
+    // Double the table and reinsert every string
+    void grow() {
+        slots.assign(slots.empty() ? 64 : 2 * slots.size(), 0);
+        size_t mask = slots.size() - 1;
+        for (uint32_t id = 0; id < hashes.size(); id++) {
+            size_t slot = hashes[id] & mask;
+            while (slots[slot]) slot = (slot + 1) & mask;
+            slots[slot] = id + 1;
+        }
+    }
+
+public:
+    SymbolPool() : offsets(1, 0) {}
+
+    // Index of text, adding it if it is new
+    uint32_t intern(std::string_view text) {
+        if (2 * (hashes.size() + 1) > slots.size()) grow();
+        uint32_t h = hash(text);
+        size_t mask = slots.size() - 1;
+        size_t slot = h & mask;
+        for (; slots[slot]; slot = (slot + 1) & mask) {
+            uint32_t id = slots[slot] - 1;
+            if (hashes[id] == h && this->text(id) == text) return id;
+        }
+        uint32_t id = (uint32_t)hashes.size();
+        slots[slot] = id + 1;
+        hashes.push_back(h);
+        chars.append(text);
+        offsets.push_back((uint32_t)chars.size());
+        return id;
+    }
+
+    std::string_view text(uint32_t id) const {
+        return std::string_view(chars).substr(offsets[id], offsets[id + 1] - offsets[id]);
+    }
+
+    size_t size() const {
+        return hashes.size();
+    }
+
+    void clear() {
+        chars.clear();
+        offsets.assign(1, 0);
+        hashes.clear();
+        slots.clear();
+    }
+};
+
+// Generated code: packed instructions plus the pools their operands index
+struct Program {
+    std::vector<Instruction> code;
+    SymbolPool variables;            // PushVar operands, by name
+    SymbolPool constants;            // PushConst operands, as written
+    std::vector<double> values;      // value of each constant
+
+    void clear() {
+        code.clear();
+        variables.clear();
+        constants.clear();
+        values.clear();
+    }
+
+    void pushVariable(std::string_view name) {
+        code.push_back({Opcode::PushVar, variables.intern(name)});
+    }
+
+    void pushConstant(std::string_view literal) {
+        uint32_t id = constants.intern(literal);
+        if (id == values.size()) {
+            double value = 0;
+            std::from_chars(literal.data(), literal.data() + literal.size(), value);
+            values.push_back(value);
+        }
+        code.push_back({Opcode::PushConst, id});
+    }
+
+    void emit(Opcode op) {
+        code.push_back({op, 0});
+    }
+
+    // Operand of a push as text (its variable name or literal)
+    std::string_view operandText(const Instruction& instruction) const {
+        return instruction.op == Opcode::PushVar ? variables.text(instruction.operand)
+                                                 : constants.text(instruction.operand);
+    }
+
+    // Text view of one instruction, e.g. "PUSH a" or "ADD"
+    std::string text(const Instruction& instruction) const {
+        if (instruction.op == Opcode::PushVar || instruction.op == Opcode::PushConst) {
+            std::string text = "PUSH ";
+            text += operandText(instruction);
+            return text;
+        }
+        return mnemonic(instruction.op);
+    }
+
+    static const char* mnemonic(Opcode op) {
+        switch (op) {
+            case Opcode::PushVar:
+            case Opcode::PushConst: return "PUSH";
+            case Opcode::Add: return "ADD";
+            case Opcode::Sub: return "SUB";
+            case Opcode::Mul: return "MUL";
+            case Opcode::Div: return "DIV";
+        }
+        return "";
+    }
+};
+
+#endif
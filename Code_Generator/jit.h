@@ -0,0 +1,242 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "instruction.h"
+#include "vm.h"
+
+// Native code needs x86-64 with the System V calling convention (Linux,
+// macOS, BSD) and mmap; elsewhere JitExpression always interprets. Build
+// with -DJIT_DISABLE to force the interpreter.
+#if defined(__x86_64__) && !defined(_WIN32) && !defined(JIT_DISABLE)
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+// Compiled expression: double f(const double* variables), where
+// variables[i] is the value of variable pool entry i (see bindVariables)
+typedef double (*JitFunction)(const double* variables);
+
+// Translates a generated program into x86-64 machine code in an mmap'd
+// buffer, falling back to StackVM when that is not possible.
+//
+// The operand stack is allocated to SSE registers: stack position p lives
+// in xmm<p>, so PUSH is one load and an operation is one addsd/subsd/
+// mulsd/divsd between two registers. Positions from SPILL_BASE up live in
+// a frame on the machine stack, and operations on them take a memory
+// operand, with xmm15 as scratch. The result is at position 0, which is
+// xmm0, the return register. Code is written to a read-write mapping that
+// is then made read-execute, never both.
+class JitExpression {
+public:
+    static const int SPILL_BASE = 15;
+
+private:
+    StackVM interpreter;
+    JitFunction function = nullptr;
+    void* buffer = nullptr;
+    size_t bufferSize = 0;
+
+#ifdef JIT_X86_64
+    enum { RAX = 0, RSP = 4, RDI = 7, SCRATCH = 15 };
+
+    std::vector<uint8_t> code;
+
+    void emit(uint8_t byte) {
+        code.push_back(byte);
+    }
+
+    void emit32(uint32_t value) {
+        for (int i = 0; i < 4; i++) emit((uint8_t)(value >> (8 * i)));
+    }
+
+    void emit64(uint64_t value) {
+        for (int i = 0; i < 8; i++) emit((uint8_t)(value >> (8 * i)));
+    }
+
+    // prefix [REX] 0F opcode with xmm<reg> and xmm<rm>
+    void sseRegister(uint8_t prefix, uint8_t opcode, int reg, int rm) {
+        emit(prefix);
+        if (reg >= 8 || rm >= 8) emit(0x40 | (reg >= 8 ? 4 : 0) | (rm >= 8 ? 1 : 0));
+        emit(0x0F);
+        emit(opcode);
+        emit(0xC0 | (reg & 7) << 3 | (rm & 7));
+    }
+
+    // prefix [REX] 0F opcode with xmm<reg> and [base + disp] (base is
+    // RDI or RSP; disp is always 32-bit)
+    void sseMemory(uint8_t prefix, uint8_t opcode, int reg, int base, int32_t disp) {
+        emit(prefix);
+        if (reg >= 8) emit(0x44);
+        emit(0x0F);
+        emit(opcode);
+        emit(0x80 | (reg & 7) << 3 | base);
+        if (base == RSP) emit(0x24);    // SIB: [rsp]
+        emit32((uint32_t)disp);
+    }
+
+    static int32_t spillOffset(size_t position) {
+        return (int32_t)(8 * (position - SPILL_BASE));
+    }
+
+    // Load the double at [base + disp] into stack position p
+    void load(size_t p, int base, int32_t disp) {
+        if (p < SPILL_BASE) {
+            sseMemory(0xF2, 0x10, (int)p, base, disp);                // movsd xmm<p>, [..]
+        } else {
+            sseMemory(0xF2, 0x10, SCRATCH, base, disp);               // movsd xmm15, [..]
+            sseMemory(0xF2, 0x11, SCRATCH, RSP, spillOffset(p));      // movsd [spill], xmm15
+        }
+    }
+
+    // Load the constant value into stack position p
+    void loadConstant(size_t p, double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        emit(0x48);                         // mov rax, imm64
+        emit(0xB8 | RAX);
+        emit64(bits);
+        if (p < SPILL_BASE) {
+            emit(0x66);                     // movq xmm<p>, rax
+            emit(p >= 8 ? 0x4C : 0x48);
+            emit(0x0F);
+            emit(0x6E);
+            emit(0xC0 | (p & 7) << 3 | RAX);
+        } else {
+            emit(0x48);                     // mov [rsp + spill], rax
+            emit(0x89);
+            emit(0x84);
+            emit(0x24);
+            emit32((uint32_t)spillOffset(p));
+        }
+    }
+
+    // Position p = p op position p + 1
+    void operate(size_t p, uint8_t opcode) {
+        if (p + 1 < SPILL_BASE) {
+            sseRegister(0xF2, opcode, (int)p, (int)p + 1);
+        } else if (p < SPILL_BASE) {
+            sseMemory(0xF2, opcode, (int)p, RSP, spillOffset(p + 1));
+        } else {
+            sseMemory(0xF2, 0x10, SCRATCH, RSP, spillOffset(p));
+            sseMemory(0xF2, opcode, SCRATCH, RSP, spillOffset(p + 1));
+            sseMemory(0xF2, 0x11, SCRATCH, RSP, spillOffset(p));
+        }
+    }
+
+    // Machine code for program, whose stack holds at most depth values
+    void generate(const Program& program, size_t depth) {
+        code.clear();
+        uint32_t frame = 0;
+        if (depth > SPILL_BASE) {
+            frame = (uint32_t)((8 * (depth - SPILL_BASE) + 15) & ~size_t(15));
+            emit(0x48);                     // sub rsp, frame
+            emit(0x81);
+            emit(0xEC);
+            emit32(frame);
+        }
+
+        size_t sp = 0;
+        for (const Instruction& instruction : program.code) {
+            switch (instruction.op) {
+                case Opcode::PushVar:
+                    load(sp++, RDI, (int32_t)(8 * instruction.operand));
+                    break;
+                case Opcode::PushConst:
+                    loadConstant(sp++, program.values[instruction.operand]);
+                    break;
+                case Opcode::Add:
+                    operate(sp -= 2, 0x58);     // addsd
+                    sp++;
+                    break;
+                case Opcode::Sub:
+                    operate(sp -= 2, 0x5C);     // subsd
+                    sp++;
+                    break;
+                case Opcode::Mul:
+                    operate(sp -= 2, 0x59);     // mulsd
+                    sp++;
+                    break;
+                case Opcode::Div:
+                    operate(sp -= 2, 0x5E);     // divsd
+                    sp++;
+                    break;
+            }
+        }
+
+        if (frame) {
+            emit(0x48);                     // add rsp, frame
+            emit(0x81);
+            emit(0xC4);
+            emit32(frame);
+        }
+        emit(0xC3);                         // ret
+    }
+#endif
+
+    void release() {
+#ifdef JIT_X86_64
+        if (buffer) munmap(buffer, bufferSize);
+#endif
+        buffer = nullptr;
+        bufferSize = 0;
+        function = nullptr;
+    }
+
+public:
+    JitExpression() = default;
+    JitExpression(const JitExpression&) = delete;
+    JitExpression& operator=(const JitExpression&) = delete;
+
+    ~JitExpression() {
+        release();
+    }
+
+    // Prepare program for run(): always loads the interpreter, then
+    // compiles to native code where supported. Returns false only if the
+    // program is malformed (see StackVM::load); the expression is then
+    // empty, as the previous program is released first. The program must
+    // outlive the expression's use of it.
+    bool compile(const Program& program) {
+        release();
+        if (!interpreter.load(program)) return false;
+
+#ifdef JIT_X86_64
+        generate(program, stackDepth(program));
+        size_t size = code.size();
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return true;
+        memcpy(memory, code.data(), size);
+        if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(memory, size);
+            return true;
+        }
+        buffer = memory;
+        bufferSize = size;
+        function = (JitFunction)memory;
+#endif
+        return true;
+    }
+
+    // Native function for the compiled program, or nullptr when run()
+    // interprets
+    JitFunction native() const {
+        return function;
+    }
+
+    // Bytes of machine code generated (0 when interpreting)
+    size_t codeSize() const {
+        return bufferSize;
+    }
+
+    // Evaluate the program: natively if compiled, otherwise on StackVM;
+    // NaN if nothing is compiled
+    double run(const double* variables) const {
+        if (function) return function(variables);
+        return interpreter.run(variables);
+    }
+};
+
+#endif
@@ -0,0 +1,120 @@
+// Regression test: BatchVM results and its unloaded state
+//
+//   g++ -std=c++17 -g -fsanitize=address test_batch.cpp -o test_batch
+//   ./test_batch
+//
+// Evaluates expressions over a few thousand rows (more than one block,
+// with a partial last block) and checks every row against StackVM. Then
+// checks that a VM with nothing loaded, or after a failed load of a
+// malformed program, fills the output with NaN instead of running the
+// previous program.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "batch.h"
+#include "code_generator.h"
+
+using namespace std;
+
+// Rows to evaluate: two full blocks and part of a third
+static const size_t ROWS = 2 * BatchVM::BLOCK_ROWS + 100;
+
+static bool allNaN(const vector<double>& out) {
+    for (double value : out) {
+        if (!isnan(value)) return false;
+    }
+    return true;
+}
+
+// Check BatchVM against StackVM on every row for expression
+static bool checkExpression(const string& expression, mt19937& rng) {
+    CodeGenerator generator;
+    generator.compile(expression);
+    const Program& program = generator.getProgram();
+
+    uniform_real_distribution<double> value(-10, 10);
+    vector<vector<double>> data(program.variables.size(), vector<double>(ROWS));
+    vector<const double*> columns;
+    for (vector<double>& column : data) {
+        for (double& x : column) x = value(rng);
+        columns.push_back(column.data());
+    }
+
+    BatchVM batch;
+    StackVM vm;
+    if (!batch.load(program) || !vm.load(program)) {
+        fprintf(stderr, "'%s': load failed\n", expression.c_str());
+        return false;
+    }
+    vector<double> out(ROWS);
+    batch.run(columns.data(), ROWS, out.data());
+
+    vector<double> row(program.variables.size());
+    for (size_t r = 0; r < ROWS; r++) {
+        for (size_t v = 0; v < row.size(); v++) row[v] = data[v][r];
+        double expected = vm.run(row.data());
+        if (out[r] != expected && !(isnan(out[r]) && isnan(expected))) {
+            fprintf(stderr, "'%s': row %zu is %g, not %g\n", expression.c_str(), r, out[r], expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    mt19937 rng(12345);
+    int failures = 0;
+
+    const char* expressions[] = {
+        "a",
+        "2.5",
+        "1 + 2 * 3",
+        "a + b * c",
+        "(a - b) / (c + 1.5)",
+        "2 * a + 3 * a * a - b / 4",
+        "((a + b) * (c - d)) / ((a - c) * (b + d))",
+    };
+    for (const char* expression : expressions) {
+        failures += !checkExpression(expression, rng);
+    }
+
+    CodeGenerator good, bad;
+    good.compile("a + b");
+    bad.compile("a *");
+    vector<double> a(ROWS, 1), b(ROWS, 2);
+    const double* columns[] = { a.data(), b.data() };
+    vector<double> out(ROWS, 0);
+
+    BatchVM batch;
+    batch.run(columns, ROWS, out.data());
+    if (!allNaN(out)) {
+        fprintf(stderr, "run() without a program did not return NaN\n");
+        failures++;
+    }
+
+    if (!batch.load(good.getProgram())) {
+        fprintf(stderr, "'a + b' did not load\n");
+        failures++;
+    }
+    if (batch.load(bad.getProgram())) {
+        fprintf(stderr, "'a *' loaded\n");
+        failures++;
+    }
+    fill(out.begin(), out.end(), 0);
+    batch.run(columns, ROWS, out.data());
+    if (!allNaN(out)) {
+        fprintf(stderr, "run() after a failed load did not return NaN (got %g)\n", out[0]);
+        failures++;
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d failures\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("BatchVM agrees with StackVM and stays unloaded after a failed load\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string_view>
+
+// Kinds of tokens in an arithmetic expression
+enum class TokenType {
+    Identifier,     // [A-Za-z_][A-Za-z0-9_]*
+    Integer,        // [0-9]+
+    Float,          // 1.5, .5, 2., 1e-3, 2.5E+4
+    Operator,       // + - * /
+    LeftParen,
+    RightParen,
+    End             // end of input
+};
+
+// A token is a view into the expression text: nothing is copied, so the
+// text must outlive the tokens
+struct Token {
+    TokenType type;
+    std::string_view text;
+
+    bool isOperand() const {
+        return type == TokenType::Identifier || type == TokenType::Integer || type == TokenType::Float;
+    }
+};
+
+// Splits an expression into tokens on demand, one pass over the buffer
+// with no allocation. Whitespace and characters that start no token are
+// skipped.
+class Tokenizer {
+private:
+    std::string_view input;
+    size_t pos;
+
+    static bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool isIdentifierStart(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool isIdentifierChar(char c) {
+        return isIdentifierStart(c) || isDigit(c);
+    }
+
+    size_t skipDigits(size_t i) const {
+        while (i < input.size() && isDigit(input[i])) i++;
+        return i;
+    }
+
+    // End of the number starting at pos; sets isFloat if it has a
+    // fraction or an exponent
+    size_t scanNumber(bool& isFloat) const {
+        size_t i = skipDigits(pos);
+        isFloat = false;
+        if (i < input.size() && input[i] == '.') {
+            isFloat = true;
+            i = skipDigits(i + 1);
+        }
+        // An exponent needs at least one digit, otherwise "2e" is 2 then e
+        if (i < input.size() && (input[i] == 'e' || input[i] == 'E')) {
+            size_t j = i + 1;
+            if (j < input.size() && (input[j] == '+' || input[j] == '-')) j++;
+            if (j < input.size() && isDigit(input[j])) {
+                isFloat = true;
+                i = skipDigits(j);
+            }
+        }
+        return i;
+    }
+
+public:
+    explicit Tokenizer(std::string_view input) : input(input), pos(0) {}
+
+    // Next token, or a token of type End once the input is exhausted
+    Token next() {
+        while (pos < input.size()) {
+            char c = input[pos];
+            size_t start = pos;
+            TokenType type;
+
+            if (isIdentifierStart(c)) {
+                pos++;
+                while (pos < input.size() && isIdentifierChar(input[pos])) pos++;
+                type = TokenType::Identifier;
+            } else if (isDigit(c) || (c == '.' && pos + 1 < input.size() && isDigit(input[pos + 1]))) {
+                bool isFloat;
+                pos = scanNumber(isFloat);
+                type = isFloat ? TokenType::Float : TokenType::Integer;
+            } else if (c == '+' || c == '-' || c == '*' || c == '/') {
+                pos++;
+                type = TokenType::Operator;
+            } else if (c == '(') {
+                pos++;
+                type = TokenType::LeftParen;
+            } else if (c == ')') {
+                pos++;
+                type = TokenType::RightParen;
+            } else {
+                pos++;      // whitespace or a stray character
+                continue;
+            }
+            return Token{type, input.substr(start, pos - start)};
+        }
+        return Token{TokenType::End, input.substr(input.size())};
+    }
+};
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef VM_H
+#define VM_H
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "instruction.h"
+
+// Direct-threaded dispatch needs the GCC/Clang labels-as-values extension;
+// build with -DVM_NO_COMPUTED_GOTO to force the switch loop
+#if defined(__GNUC__) && !defined(VM_NO_COMPUTED_GOTO)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+// Values of a program's variables in pool order, for StackVM::run. Names
+// missing from bindings get NaN, so an unbound variable shows up in the
+// result instead of silently reading as 0.
+inline std::vector<double> bindVariables(const Program& program,
+                                         const std::unordered_map<std::string, double>& bindings) {
+    std::vector<double> values(program.variables.size(), NAN);
+    for (uint32_t i = 0; i < program.variables.size(); i++) {
+        auto it = bindings.find(std::string(program.variables.text(i)));
+        if (it != bindings.end()) values[i] = it->second;
+    }
+    return values;
+}
+
+// Largest number of values program holds on the stack, or 0 if it is
+// malformed (an operation without two operands, or not exactly one value
+// left at the end)
+inline size_t stackDepth(const Program& program) {
+    size_t depth = 0, maxDepth = 0;
+    for (const Instruction& instruction : program.code) {
+        if (instruction.op == Opcode::PushVar || instruction.op == Opcode::PushConst) {
+            if (++depth > maxDepth) maxDepth = depth;
+        } else {
+            if (depth < 2) return 0;
+            depth--;
+        }
+    }
+    return depth == 1 ? maxDepth : 0;
+}
+
+// Numeric stack machine for generated programs. load() checks the program
+// once (every operation has two operands, one value is left, the stack
+// never exceeds STACK_SIZE), so the run loops do no bounds checks; with
+// computed goto it also translates the program into threaded code, one
+// handler address per instruction with constants already resolved.
+class StackVM {
+public:
+    static const size_t STACK_SIZE = 1024;
+
+private:
+    // One threaded instruction: the address of its handler and its operand
+    struct Threaded {
+        const void* handler;
+        union {
+            uint32_t variable;  // PushVar
+            double value;       // PushConst
+        };
+    };
+
+    const Program* program = nullptr;
+    std::vector<Threaded> threaded;
+
+#ifdef VM_COMPUTED_GOTO
+    // Runs threaded code; with code == nullptr, returns the handler table
+    // (indexed by Opcode, then Halt) through labels instead
+    static double execute(const Threaded* code, const double* variables, const void* const** labels) {
+        static const void* const handlers[] = {
+            &&push_var, &&push_const, &&add, &&sub, &&mul, &&div, &&halt
+        };
+        if (!code) {
+            *labels = handlers;
+            return 0;
+        }
+
+        double stack[STACK_SIZE];
+        double* sp = stack;         // one past the top
+        const Threaded* ip = code;
+        goto *ip->handler;
+
+    push_var:
+        *sp++ = variables[ip->variable];
+        goto *(++ip)->handler;
+    push_const:
+        *sp++ = ip->value;
+        goto *(++ip)->handler;
+    add:
+        sp--;
+        sp[-1] += sp[0];
+        goto *(++ip)->handler;
+    sub:
+        sp--;
+        sp[-1] -= sp[0];
+        goto *(++ip)->handler;
+    mul:
+        sp--;
+        sp[-1] *= sp[0];
+        goto *(++ip)->handler;
+    div:
+        sp--;
+        sp[-1] /= sp[0];
+        goto *(++ip)->handler;
+    halt:
+        return stack[0];
+    }
+#endif
+
+public:
+    // Check program and prepare it for run(); returns false if it would
+    // underflow, overflow the stack or not leave exactly one value, and
+    // leaves the VM unloaded. The program must outlive the VM's use of it.
+    bool load(const Program& code) {
+        program = nullptr;
+        threaded.clear();
+        size_t depth = stackDepth(code);
+        if (depth == 0 || depth > STACK_SIZE) return false;
+        program = &code;
+
+#ifdef VM_COMPUTED_GOTO
+        const void* const* labels;
+        execute(nullptr, nullptr, &labels);
+        threaded.resize(code.code.size() + 1);
+        for (size_t i = 0; i < code.code.size(); i++) {
+            const Instruction& instruction = code.code[i];
+            threaded[i].handler = labels[(int)instruction.op];
+            if (instruction.op == Opcode::PushConst) {
+                threaded[i].value = code.values[instruction.operand];
+            } else {
+                threaded[i].variable = instruction.operand;
+            }
+        }
+        threaded.back().handler = labels[(int)Opcode::Div + 1];
+#endif
+        return true;
+    }
+
+    // Evaluate the loaded program; variables[i] is the value of variable
+    // pool entry i (see bindVariables). NaN if no program is loaded.
+    double run(const double* variables) const {
+        if (!program) return NAN;
+#ifdef VM_COMPUTED_GOTO
+        return execute(threaded.data(), variables, nullptr);
+#else
+        return runSwitch(variables);
+#endif
+    }
+
+    // Evaluate the loaded program with a switch over the packed
+    // instructions (the portable dispatch loop); NaN if none is loaded
+    double runSwitch(const double* variables) const {
+        if (!program) return NAN;
+        double stack[STACK_SIZE];
+        double* sp = stack;         // one past the top
+        const double* constants = program->values.data();
+
+        for (const Instruction& instruction : program->code) {
+            switch (instruction.op) {
+                case Opcode::PushVar:
+                    *sp++ = variables[instruction.operand];
+                    break;
+                case Opcode::PushConst:
+                    *sp++ = constants[instruction.operand];
+                    break;
+                case Opcode::Add:
+                    sp--;
+                    sp[-1] += sp[0];
+                    break;
+                case Opcode::Sub:
+                    sp--;
+                    sp[-1] -= sp[0];
+                    break;
+                case Opcode::Mul:
+                    sp--;
+                    sp[-1] *= sp[0];
+                    break;
+                case Opcode::Div:
+                    sp--;
+                    sp[-1] /= sp[0];
+                    break;
+            }
+        }
+        return stack[0];
+    }
+};
+
+#endif
@@ -0,0 +1,133 @@
+// Microbenchmark: byte-class table lookup vs. linear symbol search
+//
+//   gcc -O2 bench_classmap.c dfa.c regex.c minimize.c stateset.c -o bench_classmap
+//   ./bench_classmap [megabytes]
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dfa.h"
+#include "regex.h"
+#include "minimize.h"
+
+// Previous layout: linear search of the symbol list for every byte,
+// -1 branch for characters outside the alphabet, one column per symbol
+typedef struct {
+    int num_symbols;
+    char symbols[256];
+    int* table;
+    int start_state;
+    const bool* accepting_states;
+} LinearDFA;
+
+static int getSymbolIndex(const LinearDFA* dfa, char symbol) {
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        if (dfa->symbols[i] == symbol) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool runLinear(const LinearDFA* dfa, const char* str, size_t len) {
+    int state = dfa->start_state;
+    for (size_t i = 0; i < len; i++) {
+        int symbol_idx = getSymbolIndex(dfa, str[i]);
+        if (symbol_idx == -1) {
+            return false;
+        }
+        state = dfa->table[state * dfa->num_symbols + symbol_idx];
+    }
+    return dfa->accepting_states[state];
+}
+
+static void buildLinear(const DFA* dfa, LinearDFA* linear) {
+    linear->num_symbols = dfa->num_symbols;
+    memcpy(linear->symbols, dfa->symbols, dfa->num_symbols);
+    linear->table = xmalloc((size_t)dfa->num_states * dfa->num_symbols * sizeof(int));
+    for (int s = 0; s < dfa->num_states; s++) {
+        for (int j = 0; j < dfa->num_symbols; j++) {
+            int cls = dfa->class_map[(unsigned char)dfa->symbols[j]];
+            linear->table[s * dfa->num_symbols + j] = dfa->transition_table[s * dfa->num_classes + cls];
+        }
+    }
+    linear->start_state = dfa->start_state;
+    linear->accepting_states = dfa->accepting_states;
+}
+
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 64;
+    size_t len = megabytes << 20;
+
+    struct {
+        const char* regex;
+        const char* input_chars;
+    } cases[] = {
+        {"(a|b)*abb", "ab"},
+        {"(0|1)*01", "01"},
+        {"[a-z0-9._]+@[a-z0-9]+\\.(com|org|net)", "abcdefghijklmnopqrstuvwxyz0123456789._@"},
+    };
+    int num_cases = sizeof(cases) / sizeof(cases[0]);
+
+    char* input = xmalloc(len);
+    srand(12345);
+
+    printf("Input size: %zu MB, best of 3 runs\n\n", megabytes);
+    printf("%-40s %6s %7s %12s %12s %8s\n",
+           "Pattern", "States", "Classes", "linear ns/B", "class ns/B", "Speedup");
+
+    for (int c = 0; c < num_cases; c++) {
+        DFA dfa;
+        char error[256];
+        if (!compileRegex(cases[c].regex, &dfa, error, sizeof(error))) {
+            fprintf(stderr, "✗ Error: %s\n", error);
+            return EXIT_FAILURE;
+        }
+        MinimizeReport report;
+        minimizeDFA(&dfa, &report);
+
+        LinearDFA linear;
+        buildLinear(&dfa, &linear);
+
+        size_t num_chars = strlen(cases[c].input_chars);
+        for (size_t i = 0; i < len; i++) {
+            input[i] = cases[c].input_chars[rand() % num_chars];
+        }
+
+        double best_linear = 1e30, best_class = 1e30;
+        bool result_linear = false, result_class = false;
+        for (int run = 0; run < 3; run++) {
+            double t0 = seconds();
+            result_linear = runLinear(&linear, input, len);
+            double t1 = seconds();
+            result_class = dfa_accepts(&dfa, input, len);
+            double t2 = seconds();
+            if (t1 - t0 < best_linear) best_linear = t1 - t0;
+            if (t2 - t1 < best_class) best_class = t2 - t1;
+        }
+
+        if (result_linear != result_class) {
+            fprintf(stderr, "✗ Error: paths disagree on '%s'\n", cases[c].regex);
+            return EXIT_FAILURE;
+        }
+
+        printf("%-40s %6d %7d %12.3f %12.3f %7.2fx\n",
+               cases[c].regex, dfa.num_states, dfa.num_classes,
+               best_linear * 1e9 / len, best_class * 1e9 / len,
+               best_linear / best_class);
+
+        free(linear.table);
+        freeDFA(&dfa);
+    }
+
+    free(input);
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Benchmark: maximal-munch DFA lexer vs. an ad hoc character-class tokenizer
+//
+//   gcc -O2 bench_lexer.c lexer.c dfa.c regex.c minimize.c stateset.c -o bench_lexer
+//   ./bench_lexer [megabytes]
+//
+// The input is random arithmetic in the Code_Generator's language:
+// identifiers, numbers, + - * / and parentheses separated by spaces.
+// The hand-written side scans it the way infixToPostfix does (isspace /
+// isalnum / isOperator one character at a time) but groups runs of
+// alphanumerics into one token, so both sides emit the same tokens.
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <time.h>
+#include "lexer.h"
+
+#define BATCH_TOKENS 4096
+
+enum { TOKEN_IDENT, TOKEN_NUMBER, TOKEN_OPERATOR, TOKEN_LPAREN, TOKEN_RPAREN };
+
+static const LexRule rules[] = {
+    { "[ \\t\\n]+", LEX_SKIP },
+    { "[A-Za-z_][A-Za-z0-9_]*", TOKEN_IDENT },
+    { "[0-9]+", TOKEN_NUMBER },
+    { "[-+*/]", TOKEN_OPERATOR },
+    { "\\(", TOKEN_LPAREN },
+    { "\\)", TOKEN_RPAREN },
+};
+
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool isOperator(char c) {
+    return c == '+' || c == '-' || c == '*' || c == '/';
+}
+
+// Ad hoc tokenizer with the same interface as lexBuffer
+static size_t lexByHand(const char* buf, size_t len, size_t* offset, Token* tokens, size_t max_tokens) {
+    size_t pos = *offset, count = 0;
+    while (pos < len && count < max_tokens) {
+        char c = buf[pos];
+        size_t end = pos + 1;
+        int id = LEX_ERROR;
+        if (isspace((unsigned char)c)) {
+            while (end < len && isspace((unsigned char)buf[end])) end++;
+            pos = end;
+            continue;
+        }
+        if (isalpha((unsigned char)c) || c == '_') {
+            while (end < len && (isalnum((unsigned char)buf[end]) || buf[end] == '_')) end++;
+            id = TOKEN_IDENT;
+        } else if (isdigit((unsigned char)c)) {
+            while (end < len && isdigit((unsigned char)buf[end])) end++;
+            id = TOKEN_NUMBER;
+        } else if (isOperator(c)) {
+            id = TOKEN_OPERATOR;
+        } else if (c == '(') {
+            id = TOKEN_LPAREN;
+        } else if (c == ')') {
+            id = TOKEN_RPAREN;
+        }
+        tokens[count].offset = pos;
+        tokens[count].length = end - pos;
+        tokens[count].id = id;
+        count++;
+        pos = end;
+    }
+    *offset = pos;
+    return count;
+}
+
+// Random expression text: operands of 1-12 characters between operators
+static void generateExpressions(char* buf, size_t len) {
+    static const char ident_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+    size_t i = 0;
+    int depth = 0;
+    while (i < len) {
+        if (rand() % 4 == 0 && depth < 8) {
+            buf[i++] = '(';
+            depth++;
+            continue;
+        }
+        int operand_len = 1 + rand() % 12;
+        bool number = rand() % 3 == 0;
+        for (int j = 0; j < operand_len && i < len; j++) {
+            buf[i++] = number ? (char)('0' + rand() % 10)
+                              : ident_chars[j == 0 ? rand() % 53 : rand() % 63];
+        }
+        while (depth > 0 && rand() % 3 == 0 && i < len) {
+            buf[i++] = ')';
+            depth--;
+        }
+        if (i < len) buf[i++] = rand() % 16 == 0 ? '\n' : ' ';
+        if (i < len) buf[i++] = "+-*/"[rand() % 4];
+        if (i < len) buf[i++] = ' ';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 64;
+    size_t len = megabytes << 20;
+
+    Lexer lexer;
+    char error[256];
+    if (!compileLexer(rules, sizeof(rules) / sizeof(rules[0]), &lexer, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    char* input = xmalloc(len);
+    srand(12345);
+    generateExpressions(input, len);
+    Token* dfa_tokens = xmalloc(BATCH_TOKENS * sizeof(Token));
+    Token* hand_tokens = xmalloc(BATCH_TOKENS * sizeof(Token));
+
+    // Both tokenizers must agree token for token
+    size_t dfa_offset = 0, hand_offset = 0, total = 0;
+    while (dfa_offset < len) {
+        size_t got = lexBuffer(&lexer, input, len, &dfa_offset, dfa_tokens, BATCH_TOKENS);
+        size_t expected = lexByHand(input, len, &hand_offset, hand_tokens, BATCH_TOKENS);
+        bool same = got == expected;
+        for (size_t t = 0; t < got && same; t++) {
+            same = dfa_tokens[t].offset == hand_tokens[t].offset &&
+                   dfa_tokens[t].length == hand_tokens[t].length &&
+                   dfa_tokens[t].id == hand_tokens[t].id;
+        }
+        if (!same) {
+            fprintf(stderr, "✗ Error: tokenizers disagree near offset %zu\n", dfa_offset);
+            return EXIT_FAILURE;
+        }
+        total += got;
+    }
+
+    printf("Input: %zu MB of expressions, %zu tokens (%d DFA states), best of 3 runs\n\n",
+           megabytes, total, lexer.dfa.num_states);
+    printf("%-12s %12s %10s %10s\n", "Tokenizer", "Mtokens/s", "MB/s", "ns/token");
+
+    const char* names[2] = { "DFA lexer", "ad hoc" };
+    double best[2] = { 1e30, 1e30 };
+    for (int run = 0; run < 3; run++) {
+        for (int side = 0; side < 2; side++) {
+            size_t offset = 0, count = 0;
+            double start = seconds();
+            while (offset < len) {
+                count += side == 0
+                    ? lexBuffer(&lexer, input, len, &offset, dfa_tokens, BATCH_TOKENS)
+                    : lexByHand(input, len, &offset, hand_tokens, BATCH_TOKENS);
+            }
+            double elapsed = seconds() - start;
+            if (count != total) {
+                fprintf(stderr, "✗ Error: token count changed between runs\n");
+                return EXIT_FAILURE;
+            }
+            if (elapsed < best[side]) best[side] = elapsed;
+        }
+    }
+    for (int side = 0; side < 2; side++) {
+        printf("%-12s %12.1f %10.1f %10.2f\n", names[side], total / best[side] / 1e6,
+               len / best[side] / 1e6, best[side] * 1e9 / total);
+    }
+
+    free(dfa_tokens);
+    free(hand_tokens);
+    free(input);
+    freeLexer(&lexer);
+    return 0;
+}
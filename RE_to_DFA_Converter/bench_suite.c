@@ -0,0 +1,229 @@
+// Throughput suite: every validation path on synthetic inputs
+//
+//   gcc -O2 bench_suite.c dfa.c regex.c minimize.c stateset.c lazy.c -o bench_suite
+//   ./bench_suite [max-megabytes] > converter.csv
+//
+// Inputs come from three generators, each driven by the pattern's DFA:
+//   uniform    random alphabet symbols
+//   self-loop  shortest path to a live state with a self-loop, then that
+//              symbol repeated (best case: one state, one cache line)
+//   ping-pong  random walk that moves to a different live state on every
+//              byte (worst case for the branch predictor and the cache)
+// Sizes run 1 KB, 32 KB, 1 MB, 32 MB, 1 GB up to max-megabytes (default
+// 32). Output is CSV with the same columns as "String --bench" in the
+// validator, so runs can be diffed or loaded into a spreadsheet:
+//   tool,engine,pattern,generator,bytes,threads,seconds,bytes_per_sec,ns_per_byte,tsc_ticks_per_byte,result
+// tsc_ticks_per_byte counts TSC ticks on x86 and is empty elsewhere; TSC
+// ticks run at a fixed reference rate, not core cycles.
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dfa.h"
+#include "regex.h"
+#include "minimize.h"
+#include "lazy.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#define MIN_SIZE 1024
+#define SIZE_STEP 32
+#define LAZY_CACHE_BYTES (64 * 1024)
+// Small inputs are repeated until one timing covers at least this long
+#define MIN_TIMING_SECONDS 0.02
+
+enum { GEN_UNIFORM, GEN_SELF_LOOP, GEN_PING_PONG, NUM_GENERATORS };
+static const char* generator_names[NUM_GENERATORS] = { "uniform", "self-loop", "ping-pong" };
+
+enum { ENGINE_TABLE, ENGINE_LAZY, NUM_ENGINES };
+static const char* engine_names[NUM_ENGINES] = { "dfa_accepts", "lazy_accepts" };
+
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Time-stamp counter (rdtsc on x86), 0 where unavailable
+static unsigned long long readTsc(void) {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// xorshift64*: fast, reproducible for a given seed
+static unsigned long long nextRandom(unsigned long long* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+static int stepSymbol(const DFA* dfa, int state, int symbol) {
+    return dfa->transition_table[state * dfa->num_classes + dfa->class_map[(unsigned char)dfa->symbols[symbol]]];
+}
+
+// Shortest symbol path from the start state to a live state with a
+// self-loop; returns its length and sets *loop_symbol, or -1 if none
+static int findSelfLoop(const DFA* dfa, int* path, int* loop_symbol) {
+    int n = dfa->num_states;
+    int* parent = xmalloc((size_t)n * sizeof(int));
+    int* via = xmalloc((size_t)n * sizeof(int));
+    int* queue = xmalloc((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) parent[s] = -2;
+
+    int head = 0, tail = 0, found = -1;
+    parent[dfa->start_state] = -1;
+    queue[tail++] = dfa->start_state;
+    while (head < tail && found < 0) {
+        int s = queue[head++];
+        for (int j = 0; j < dfa->num_symbols; j++) {
+            int t = stepSymbol(dfa, s, j);
+            if (t == s && s != dfa->dead_state) {
+                found = s;
+                *loop_symbol = j;
+                break;
+            }
+            if (parent[t] == -2 && t != dfa->dead_state) {
+                parent[t] = s;
+                via[t] = j;
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    int length = -1;
+    if (found >= 0) {
+        length = 0;
+        for (int s = found; parent[s] >= 0; s = parent[s]) length++;
+        int i = length;
+        for (int s = found; parent[s] >= 0; s = parent[s]) path[--i] = via[s];
+    }
+    free(parent);
+    free(via);
+    free(queue);
+    return length;
+}
+
+static void generateInput(const DFA* dfa, int gen, char* buf, size_t size, unsigned long long seed) {
+    unsigned long long rng = seed;
+    int* path = xmalloc((size_t)dfa->num_states * sizeof(int));
+    int loop_symbol = 0;
+    int path_len = gen == GEN_SELF_LOOP ? findSelfLoop(dfa, path, &loop_symbol) : -1;
+    if (gen == GEN_SELF_LOOP && path_len < 0) gen = GEN_PING_PONG;
+
+    int state = dfa->start_state;
+    for (size_t i = 0; i < size; i++) {
+        int symbol;
+        if (gen == GEN_UNIFORM) {
+            symbol = (int)(nextRandom(&rng) % (unsigned)dfa->num_symbols);
+        } else if (gen == GEN_SELF_LOOP) {
+            symbol = i < (size_t)path_len ? path[i] : loop_symbol;
+        } else {
+            // Prefer symbols that move to another live state, picked at random
+            int candidates[256], count = 0;
+            for (int j = 0; j < dfa->num_symbols; j++) {
+                int t = stepSymbol(dfa, state, j);
+                if (t != state && t != dfa->dead_state) candidates[count++] = j;
+            }
+            for (int j = 0; j < dfa->num_symbols && count == 0; j++) {
+                if (stepSymbol(dfa, state, j) != dfa->dead_state) candidates[count++] = j;
+            }
+            symbol = count > 0 ? candidates[nextRandom(&rng) % (unsigned)count]
+                               : (int)(nextRandom(&rng) % (unsigned)dfa->num_symbols);
+        }
+        buf[i] = dfa->symbols[symbol];
+        state = stepSymbol(dfa, state, symbol);
+    }
+    free(path);
+}
+
+static bool runEngine(int engine, const DFA* dfa, LazyDFA* lazy, const char* data, size_t size) {
+    return engine == ENGINE_TABLE ? dfa_accepts(dfa, data, size) : lazy_accepts(lazy, data, size);
+}
+
+int main(int argc, char* argv[]) {
+    long max_mb = argc > 1 ? atol(argv[1]) : 32;
+    if (max_mb < 1) {
+        fprintf(stderr, "Usage: %s [max-megabytes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t max_size = (size_t)max_mb << 20;
+
+    const char* patterns[] = {
+        "(a|b)*abb",
+        "(0|1)*01",
+        "[a-z0-9._]+@[a-z0-9]+\\.(com|org|net)",
+    };
+    int num_patterns = sizeof(patterns) / sizeof(patterns[0]);
+
+    char* input = xmalloc(max_size);
+    printf("tool,engine,pattern,generator,bytes,threads,seconds,bytes_per_sec,ns_per_byte,tsc_ticks_per_byte,result\n");
+
+    for (int p = 0; p < num_patterns; p++) {
+        DFA dfa;
+        LazyDFA lazy;
+        char error[256];
+        if (!compileRegex(patterns[p], &dfa, error, sizeof(error)) ||
+            !compileLazy(patterns[p], LAZY_CACHE_BYTES, &lazy, error, sizeof(error))) {
+            fprintf(stderr, "✗ Error: %s\n", error);
+            return EXIT_FAILURE;
+        }
+        MinimizeReport report;
+        minimizeDFA(&dfa, &report);
+
+        for (int g = 0; g < NUM_GENERATORS; g++) {
+            // Generate once at the largest size; smaller runs use a prefix
+            generateInput(&dfa, g, input, max_size, 12345 + g);
+
+            for (size_t size = MIN_SIZE; size <= max_size; size *= SIZE_STEP) {
+                for (int e = 0; e < NUM_ENGINES; e++) {
+                    // Calibrate repetitions (this also warms the lazy cache),
+                    // then keep the best of 3 timings
+                    size_t reps = 1, accepted = 0;
+                    for (;;) {
+                        double start = seconds();
+                        for (size_t r = 0; r < reps; r++) accepted += runEngine(e, &dfa, &lazy, input, size);
+                        if (seconds() - start >= MIN_TIMING_SECONDS || reps >= (1u << 24)) break;
+                        reps *= 2;
+                    }
+                    double best = 1e30;
+                    unsigned long long best_ticks = 0;
+                    for (int run = 0; run < 3; run++) {
+                        accepted = 0;
+                        unsigned long long c0 = readTsc();
+                        double start = seconds();
+                        for (size_t r = 0; r < reps; r++) accepted += runEngine(e, &dfa, &lazy, input, size);
+                        double elapsed = (seconds() - start) / reps;
+                        unsigned long long ticks = (readTsc() - c0) / reps;
+                        if (elapsed < best) {
+                            best = elapsed;
+                            best_ticks = ticks;
+                        }
+                    }
+
+                    // Patterns contain no '"', so quoting is enough for CSV
+                    printf("converter,%s,\"%s\",%s,%zu,1,%.9f,%.0f,%.4f,",
+                           engine_names[e], patterns[p], generator_names[g], size, best,
+                           size / best, best * 1e9 / size);
+                    if (best_ticks > 0) printf("%.4f", (double)best_ticks / size);
+                    printf(",%zu\n", accepted / reps);
+                    fflush(stdout);
+                }
+            }
+        }
+
+        freeLazyDFA(&lazy);
+        freeDFA(&dfa);
+    }
+
+    free(input);
+    return 0;
+}
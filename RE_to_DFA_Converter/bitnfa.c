@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitnfa.h"
+
+// Build the per-chunk follow tables and byte masks from the position
+// automaton (pa->words is 1 here)
+bool initBitNFA(BitNFA* nfa, const PositionAutomaton* pa) {
+    memset(nfa, 0, sizeof(*nfa));
+    if (pa->num_positions > BITNFA_MAX_POSITIONS) return false;
+
+    nfa->num_positions = pa->num_positions;
+    nfa->num_chunks = (pa->num_positions + 7) / 8;
+    nfa->first = pa->first[0];
+    nfa->end = 1ULL << pa->end_pos[0];
+    for (int b = 0; b < 256; b++) {
+        nfa->byte_mask[b] = pa->class_positions[pa->class_map[b]];
+    }
+
+    // follow[c][v] adds one position's followpos to a smaller value's entry
+    nfa->follow = xmalloc((size_t)nfa->num_chunks * sizeof(*nfa->follow));
+    for (int c = 0; c < nfa->num_chunks; c++) {
+        nfa->follow[c][0] = 0;
+        for (int v = 1; v < 256; v++) {
+            int i = 8 * c + __builtin_ctz(v);
+            uint64_t followpos = i < pa->num_positions ? pa->followpos[i] : 0;
+            nfa->follow[c][v] = nfa->follow[c][v & (v - 1)] | followpos;
+        }
+    }
+
+    nfa->regex = xmalloc(strlen(pa->description) + 1);
+    strcpy(nfa->regex, pa->description);
+    return true;
+}
+
+bool compileBitNFA(const char* pattern, BitNFA* nfa, char* err, size_t err_len) {
+    PositionAutomaton pa;
+    if (!buildPositions(&pattern, 1, &pa, err, err_len)) {
+        return false;
+    }
+    bool ok = initBitNFA(nfa, &pa);
+    if (!ok && err && err_len) {
+        snprintf(err, err_len, "Pattern has %d positions (bit-parallel limit %d)",
+                 pa.num_positions, BITNFA_MAX_POSITIONS);
+    }
+    freePositions(&pa);
+    return ok;
+}
+
+void freeBitNFA(BitNFA* nfa) {
+    free(nfa->follow);
+    free(nfa->regex);
+    nfa->follow = NULL;
+    nfa->regex = NULL;
+}
+
+// Union of followpos over set: one table load per chunk, all chunks
+// every time (skipping empty chunks costs more in branch misses)
+static inline uint64_t followSet(const BitNFA* nfa, uint64_t set) {
+    uint64_t next = 0;
+    for (int c = 0; c < nfa->num_chunks; c++) {
+        next |= nfa->follow[c][(set >> (8 * c)) & 0xFF];
+    }
+    return next;
+}
+
+// Patterns of up to 8 positions take the single-table loop
+bool bitnfa_accepts(const BitNFA* nfa, const char* str, size_t len) {
+    const uint64_t* byte_mask = nfa->byte_mask;
+    const unsigned char* p = (const unsigned char*)str;
+    uint64_t set = nfa->first;
+    if (nfa->num_chunks == 1) {
+        const uint64_t* follow = nfa->follow[0];
+        for (size_t i = 0; i < len && set; i++) {
+            set = follow[set & byte_mask[p[i]]];
+        }
+    } else {
+        for (size_t i = 0; i < len && set; i++) {
+            set = followSet(nfa, set & byte_mask[p[i]]);
+        }
+    }
+    return (set & nfa->end) != 0;
+}
+
+// Print a position set as {0, 2, 5}
+static void printPositionSet(uint64_t set) {
+    printf("{");
+    for (bool first = true; set; set &= set - 1, first = false) {
+        printf(first ? "%d" : ", %d", __builtin_ctzll(set));
+    }
+    printf("}");
+}
+
+bool validateBitNFA(const BitNFA* nfa, const char* str) {
+    uint64_t set = nfa->first;
+
+    printf("\n  Initial positions: ");
+    printPositionSet(set);
+    printf("\n  Transitions:\n");
+
+    for (int i = 0; str[i] != '\0'; i++) {
+        uint64_t next = followSet(nfa, set & nfa->byte_mask[(unsigned char)str[i]]);
+        printf("    ");
+        printPositionSet(set);
+        printf(" --(%c)--> ", str[i]);
+        printPositionSet(next);
+        if (next & nfa->end) {
+            printf(" [accepting]");
+        } else if (next == 0) {
+            printf(" [dead]");
+        }
+        printf("\n");
+        set = next;
+    }
+
+    bool accepted = (set & nfa->end) != 0;
+    printf("  Result: %s\n", accepted ? "ACCEPTED" : "REJECTED");
+    return accepted;
+}
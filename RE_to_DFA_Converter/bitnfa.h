@@ -0,0 +1,52 @@
+#ifndef BITNFA_H
+#define BITNFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "regex.h"
+
+// Largest position automaton (end marker included) simulated in one word
+#define BITNFA_MAX_POSITIONS 64
+
+// Bit-parallel simulation of a pattern's position (Glushkov) automaton.
+// The set of positions that may read the next byte is one 64-bit word,
+// the same set a DFA state stands for, so no states are ever built:
+//     set = follow(set & byte_mask[byte])
+// follow() is the union of followpos over a set; it is tabulated per
+// 8-bit chunk of the set, so a step costs one table load per chunk in
+// use (one for patterns of up to 8 positions). Construction is just
+// buildPositions plus these tables, which is why this engine wins over
+// subset construction for short patterns queried once.
+typedef struct {
+    int num_positions;
+    int num_chunks;              // 8-bit chunks of the position set in use
+    uint64_t first;              // start set
+    uint64_t end;                // bit of the end marker: accepting sets have it
+    uint64_t byte_mask[256];     // positions that match each byte
+    uint64_t (*follow)[256];     // per chunk: follow() of each chunk value
+    char* regex;
+} BitNFA;
+
+// Build the bit-parallel NFA of a single-pattern position automaton.
+// Returns false (leaving nfa empty) when it has more than
+// BITNFA_MAX_POSITIONS positions.
+bool initBitNFA(BitNFA* nfa, const PositionAutomaton* pa);
+
+// Compile pattern (compileRegex syntax) into a bit-parallel NFA. On a
+// syntax error, or when the pattern is too large, returns false and
+// writes a message into err.
+bool compileBitNFA(const char* pattern, BitNFA* nfa, char* err, size_t err_len);
+
+// Release all memory owned by the NFA
+void freeBitNFA(BitNFA* nfa);
+
+// Silent acceptance test of len bytes; stops early once no position is
+// active (the DFA's dead state)
+bool bitnfa_accepts(const BitNFA* nfa, const char* str, size_t len);
+
+// Validate string with step-by-step output of the active position sets
+// (the bit-parallel counterpart of validateString)
+bool validateBitNFA(const BitNFA* nfa, const char* str);
+
+#endif
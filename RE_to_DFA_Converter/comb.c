@@ -0,0 +1,168 @@
+#include <stdlib.h>
+#include <string.h>
+#include "comb.h"
+
+// Most common target in state's row; counts is all-zero scratch (one per
+// state) and is left all-zero
+static int rowDefault(const DFA* dfa, int state, int* counts) {
+    const int* row = dfa->transition_table + (size_t)state * dfa->num_classes;
+    int best = row[0];
+    for (int j = 0; j < dfa->num_classes; j++) {
+        if (++counts[row[j]] > counts[best]) best = row[j];
+    }
+    for (int j = 0; j < dfa->num_classes; j++) {
+        counts[row[j]] = 0;
+    }
+    return best;
+}
+
+// Fraction of transitions that differ from their row's default
+double transitionDensity(const DFA* dfa) {
+    int n = dfa->num_states, k = dfa->num_classes;
+    int* counts = xcalloc((size_t)n, sizeof(int));
+    size_t stored = 0;
+    for (int s = 0; s < n; s++) {
+        int fallback = rowDefault(dfa, s, counts);
+        for (int j = 0; j < k; j++) {
+            stored += dfa->transition_table[(size_t)s * k + j] != fallback;
+        }
+    }
+    free(counts);
+    return n > 0 ? (double)stored / ((double)n * k) : 0.0;
+}
+
+// Grow the slot array to hold at least needed slots (new slots are free)
+static void reserveSlots(CombTable* comb, int* capacity, int needed) {
+    if (needed <= *capacity) return;
+    int grown = *capacity * 2 > needed ? *capacity * 2 : needed;
+    comb->slots = xrealloc(comb->slots, (size_t)grown * sizeof(CombSlot));
+    for (int i = *capacity; i < grown; i++) {
+        comb->slots[i].next = 0;
+        comb->slots[i].check = -1;
+    }
+    *capacity = grown;
+}
+
+// Build the comb table. Rows with the most stored transitions are placed
+// first, while the slot array is still empty enough for them; each row
+// takes the lowest base at which all its stored entries fall on free slots.
+void buildCombTable(const DFA* dfa, CombTable* comb) {
+    int n = dfa->num_states, k = dfa->num_classes;
+    comb->num_states = n;
+    comb->num_classes = k;
+    comb->rows = xmalloc((size_t)n * sizeof(CombRow));
+    comb->slots = NULL;
+    comb->num_entries = 0;
+
+    int* counts = xcalloc((size_t)n, sizeof(int));
+    int* stored = xmalloc((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        comb->rows[s].base = 0;
+        comb->rows[s].default_next = rowDefault(dfa, s, counts);
+        stored[s] = 0;
+        for (int j = 0; j < k; j++) {
+            stored[s] += dfa->transition_table[(size_t)s * k + j] != comb->rows[s].default_next;
+        }
+    }
+
+    // Counting sort by stored transitions, fullest first (stable)
+    int* bucket_start = xcalloc((size_t)k + 2, sizeof(int));
+    int* order = xmalloc((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) bucket_start[k - stored[s] + 1]++;
+    for (int b = 1; b <= k + 1; b++) bucket_start[b] += bucket_start[b - 1];
+    for (int s = 0; s < n; s++) order[bucket_start[k - stored[s]]++] = s;
+
+    // Every row may be indexed with any class, so at least k slots exist
+    int capacity = 0;
+    reserveSlots(comb, &capacity, n + k);
+    comb->num_slots = k;
+    int* columns = xmalloc((size_t)k * sizeof(int));
+    int first_free = 0;
+    for (int i = 0; i < n && stored[order[i]] > 0; i++) {
+        int s = order[i];
+        const int* row = dfa->transition_table + (size_t)s * k;
+        int m = 0;
+        for (int j = 0; j < k; j++) {
+            if (row[j] != comb->rows[s].default_next) columns[m++] = j;
+        }
+
+        while (first_free < capacity && comb->slots[first_free].check >= 0) first_free++;
+        int base = first_free > columns[0] ? first_free - columns[0] : 0;
+        for (;; base++) {
+            reserveSlots(comb, &capacity, base + k);
+            int c = 0;
+            while (c < m && comb->slots[base + columns[c]].check < 0) c++;
+            if (c == m) break;
+        }
+
+        comb->rows[s].base = base;
+        for (int c = 0; c < m; c++) {
+            comb->slots[base + columns[c]].next = row[columns[c]];
+            comb->slots[base + columns[c]].check = s;
+        }
+        comb->num_entries += m;
+        if (base + k > comb->num_slots) comb->num_slots = base + k;
+    }
+    comb->slots = xrealloc(comb->slots, (size_t)comb->num_slots * sizeof(CombSlot));
+
+    free(counts);
+    free(stored);
+    free(bucket_start);
+    free(order);
+    free(columns);
+}
+
+// Every state takes a row and every stored transition a slot
+size_t combTableMinBytes(const DFA* dfa) {
+    double cells = (double)dfa->num_states * dfa->num_classes;
+    size_t stored = (size_t)(transitionDensity(dfa) * cells + 0.5);
+    return (size_t)dfa->num_states * sizeof(CombRow) + stored * sizeof(CombSlot);
+}
+
+// Keep the comb table only if it beats every dense table; one too dense
+// to win is not worth building
+bool selectCombTable(const DFA* dfa, CombTable* comb) {
+    memset(comb, 0, sizeof(*comb));
+    size_t dense = narrowTableBytes(dfa);
+    if (combTableMinBytes(dfa) >= dense) return false;
+
+    buildCombTable(dfa, comb);
+    if (combTableBytes(comb) < dense) return true;
+    freeCombTable(comb);
+    memset(comb, 0, sizeof(*comb));
+    return false;
+}
+
+// Release all memory owned by the comb table
+void freeCombTable(CombTable* comb) {
+    free(comb->rows);
+    free(comb->slots);
+    comb->rows = NULL;
+    comb->slots = NULL;
+}
+
+size_t denseTableBytes(const DFA* dfa) {
+    return (size_t)dfa->num_states * dfa->num_classes * sizeof(int);
+}
+
+size_t narrowTableBytes(const DFA* dfa) {
+    size_t width = dfa->num_states <= 256 ? 1 : dfa->num_states <= 65536 ? 2 : 4;
+    return (size_t)dfa->num_states * dfa->num_classes * width;
+}
+
+size_t combTableBytes(const CombTable* comb) {
+    return (size_t)comb->num_states * sizeof(CombRow) + (size_t)comb->num_slots * sizeof(CombSlot);
+}
+
+// State reached after len bytes from state
+int comb_run(const CombTable* comb, const unsigned char* class_map, int state,
+             const char* str, size_t len) {
+    const CombRow* rows = comb->rows;
+    const CombSlot* slots = comb->slots;
+    for (size_t i = 0; i < len; i++) {
+        const CombRow* row = &rows[state];
+        const CombSlot* slot = &slots[row->base + class_map[(unsigned char)str[i]]];
+        state = slot->check == state ? slot->next : row->default_next;
+    }
+    return state;
+}
@@ -0,0 +1,76 @@
+#ifndef COMB_H
+#define COMB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "dfa.h"
+
+// Row-displacement ("comb vector") form of a DFA's transition table.
+// Each state keeps a default target (the one most of its classes lead to,
+// usually the dead state); only the other transitions are stored. The
+// rows are overlaid in one slot array, each shifted by its own base so
+// that its stored entries land on free slots, and every slot records
+// which state owns it:
+//     slot = slots[rows[state].base + cls]
+//     next = slot.check == state ? slot.next : rows[state].default_next
+// A step costs two loads (row, slot) besides the class map, like the
+// dense table's one, but memory grows with the stored transitions instead
+// of states * classes.
+typedef struct {
+    int base;
+    int default_next;
+} CombRow;
+
+typedef struct {
+    int next;
+    int check;                // owning state, -1 for a free slot
+} CombSlot;
+
+typedef struct {
+    int num_states;
+    int num_classes;
+    CombRow* rows;            // per state
+    CombSlot* slots;
+    int num_slots;
+    int num_entries;          // transitions stored in slots
+} CombTable;
+
+// Fraction of dfa's transitions that differ from their row's most common
+// target (what a comb table has to store)
+double transitionDensity(const DFA* dfa);
+
+// Build the comb table of dfa (rows packed first-fit, fullest first)
+void buildCombTable(const DFA* dfa, CombTable* comb);
+
+// Build the comb table if it takes fewer bytes than the narrowest dense
+// table (and so than the int one too); returns whether it did (the dense
+// table is used otherwise and comb is left empty). Each stored transition
+// takes 8 bytes against a narrow entry's 1 to 4, so only sparse tables
+// qualify.
+bool selectCombTable(const DFA* dfa, CombTable* comb);
+
+// Release all memory owned by the comb table
+void freeCombTable(CombTable* comb);
+
+// Bytes used by the dense int table, the narrowest dense table (as saved
+// in .dfa files) and the comb table
+size_t denseTableBytes(const DFA* dfa);
+size_t narrowTableBytes(const DFA* dfa);
+size_t combTableBytes(const CombTable* comb);
+
+// Fewest bytes any comb table of dfa can take, without building one
+size_t combTableMinBytes(const DFA* dfa);
+
+// Transition from state on byte class cls
+static inline int comb_next(const CombTable* comb, int state, int cls) {
+    const CombRow* row = &comb->rows[state];
+    const CombSlot* slot = &comb->slots[row->base + cls];
+    return slot->check == state ? slot->next : row->default_next;
+}
+
+// dfa_run over the comb table: state reached after len bytes from state
+// (class_map is the DFA's)
+int comb_run(const CombTable* comb, const unsigned char* class_map, int state,
+             const char* str, size_t len);
+
+#endif
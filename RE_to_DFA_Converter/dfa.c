@@ -0,0 +1,382 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dfa.h"
+
+void* xmalloc(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        perror("Out of memory");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void* xcalloc(size_t count, size_t size) {
+    void* ptr = calloc(count ? count : 1, size ? size : 1);
+    if (!ptr) {
+        perror("Out of memory");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void* xrealloc(void* ptr, size_t size) {
+    ptr = realloc(ptr, size ? size : 1);
+    if (!ptr) {
+        perror("Out of memory");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// Create an empty DFA over the given alphabet
+void initDFA(DFA* dfa, const char* regex, const char* symbols, int num_symbols,
+             const unsigned char* class_map, int num_classes, int num_patterns) {
+    dfa->num_states = 0;
+    dfa->num_symbols = num_symbols;
+    dfa->symbols = xmalloc(num_symbols);
+    memcpy(dfa->symbols, symbols, num_symbols);
+
+    if (class_map) {
+        memcpy(dfa->class_map, class_map, 256);
+        dfa->num_classes = num_classes;
+    } else {
+        memset(dfa->class_map, num_symbols, 256);
+        for (int i = 0; i < num_symbols; i++) {
+            dfa->class_map[(unsigned char)symbols[i]] = (unsigned char)i;
+        }
+        dfa->num_classes = num_symbols + 1;
+    }
+
+    dfa->transition_table = NULL;
+    dfa->start_state = 0;
+    dfa->dead_state = -1;
+    dfa->accepting_states = NULL;
+    dfa->num_patterns = num_patterns;
+    dfa->accept_words = (num_patterns + 63) / 64;
+    dfa->accept_sets = NULL;
+    dfa->state_names = NULL;
+    dfa->regex = xmalloc(strlen(regex) + 1);
+    strcpy(dfa->regex, regex);
+    dfa->capacity = 0;
+}
+
+// Release all memory owned by the DFA
+void freeDFA(DFA* dfa) {
+    free(dfa->symbols);
+    free(dfa->transition_table);
+    free(dfa->accepting_states);
+    free(dfa->accept_sets);
+    free(dfa->state_names);
+    free(dfa->regex);
+    memset(dfa, 0, sizeof(*dfa));
+}
+
+// Append a new state (named q<n>) and return its index
+int addState(DFA* dfa, bool accepting) {
+    if (dfa->num_states == dfa->capacity) {
+        int capacity = dfa->capacity ? dfa->capacity * 2 : 8;
+        dfa->transition_table = xrealloc(dfa->transition_table,
+                                         (size_t)capacity * dfa->num_classes * sizeof(int));
+        dfa->accepting_states = xrealloc(dfa->accepting_states, (size_t)capacity * sizeof(bool));
+        dfa->accept_sets = xrealloc(dfa->accept_sets,
+                                    (size_t)capacity * dfa->accept_words * sizeof(uint64_t));
+        dfa->state_names = xrealloc(dfa->state_names, (size_t)capacity * STATE_NAME_LEN);
+        dfa->capacity = capacity;
+    }
+
+    int state = dfa->num_states++;
+    for (int j = 0; j < dfa->num_classes; j++) {
+        dfa->transition_table[state * dfa->num_classes + j] = state;
+    }
+    dfa->accepting_states[state] = false;
+    memset(dfa->accept_sets + (size_t)state * dfa->accept_words, 0,
+           (size_t)dfa->accept_words * sizeof(uint64_t));
+    if (accepting) {
+        addAcceptingPattern(dfa, state, 0);
+    }
+    snprintf(dfa->state_names[state], STATE_NAME_LEN, "q%d", state);
+    return state;
+}
+
+// Mark state as accepting pattern
+void addAcceptingPattern(DFA* dfa, int state, int pattern) {
+    dfa->accept_sets[(size_t)state * dfa->accept_words + pattern / 64] |= 1ULL << (pattern % 64);
+    dfa->accepting_states[state] = true;
+}
+
+// Does state accept pattern?
+bool stateMatchesPattern(const DFA* dfa, int state, int pattern) {
+    return (dfa->accept_sets[(size_t)state * dfa->accept_words + pattern / 64] >> (pattern % 64)) & 1;
+}
+
+// Accept set of state
+const uint64_t* stateAcceptSet(const DFA* dfa, int state) {
+    return dfa->accept_sets + (size_t)state * dfa->accept_words;
+}
+
+// Rebuild the DFA with old state s renumbered to state_map[s]
+void remapStates(DFA* dfa, const int* state_map, int new_count) {
+    int k = dfa->num_classes;
+    int* table = xmalloc((size_t)new_count * k * sizeof(int));
+    bool* accepting = xmalloc((size_t)new_count * sizeof(bool));
+    size_t set_bytes = (size_t)dfa->accept_words * sizeof(uint64_t);
+    uint64_t* accept_sets = xmalloc((size_t)new_count * set_bytes);
+    bool* filled = xcalloc(new_count, sizeof(bool));
+
+    for (int s = 0; s < dfa->num_states; s++) {
+        int t = state_map[s];
+        if (t < 0 || filled[t]) continue;
+        filled[t] = true;
+        accepting[t] = dfa->accepting_states[s];
+        memcpy(accept_sets + (size_t)t * dfa->accept_words, stateAcceptSet(dfa, s), set_bytes);
+        for (int j = 0; j < k; j++) {
+            table[t * k + j] = state_map[dfa->transition_table[s * k + j]];
+        }
+    }
+    free(filled);
+
+    free(dfa->transition_table);
+    free(dfa->accepting_states);
+    free(dfa->accept_sets);
+    free(dfa->state_names);
+    dfa->transition_table = table;
+    dfa->accepting_states = accepting;
+    dfa->accept_sets = accept_sets;
+    dfa->state_names = xmalloc((size_t)new_count * STATE_NAME_LEN);
+    for (int t = 0; t < new_count; t++) {
+        snprintf(dfa->state_names[t], STATE_NAME_LEN, "q%d", t);
+    }
+    dfa->start_state = state_map[dfa->start_state];
+    dfa->dead_state = dfa->dead_state >= 0 ? state_map[dfa->dead_state] : -1;
+    dfa->num_states = new_count;
+    dfa->capacity = new_count;
+}
+
+// Find the dead (trap) state
+int findDeadState(const DFA* dfa) {
+    for (int s = 0; s < dfa->num_states; s++) {
+        if (dfa->accepting_states[s]) continue;
+        const int* row = dfa->transition_table + (size_t)s * dfa->num_classes;
+        int j = 0;
+        while (j < dfa->num_classes && row[j] == s) j++;
+        if (j == dfa->num_classes) return s;
+    }
+    return -1;
+}
+
+// Printable label for an alphabet symbol (non-printable bytes as hex)
+static const char* formatSymbol(char symbol, char buf[8]) {
+    unsigned char c = (unsigned char)symbol;
+    if (c > ' ' && c < 127) {
+        buf[0] = (char)c;
+        buf[1] = '\0';
+    } else {
+        snprintf(buf, 8, "0x%02X", c);
+    }
+    return buf;
+}
+
+// State reached after len bytes
+int dfa_run(const DFA* dfa, const char* str, size_t len) {
+    const unsigned char* class_map = dfa->class_map;
+    const int* table = dfa->transition_table;
+    int num_classes = dfa->num_classes;
+    int state = dfa->start_state;
+    for (size_t i = 0; i < len; i++) {
+        state = table[state * num_classes + class_map[(unsigned char)str[i]]];
+    }
+    return state;
+}
+
+// Silent acceptance test
+bool dfa_accepts(const DFA* dfa, const char* str, size_t len) {
+    return dfa->accepting_states[dfa_run(dfa, str, len)];
+}
+
+// Print the IDs of the patterns state accepts as "{0, 2}"
+static void printAcceptSet(const DFA* dfa, int state) {
+    bool first = true;
+    printf("{");
+    for (int p = 0; p < dfa->num_patterns; p++) {
+        if (!stateMatchesPattern(dfa, state, p)) continue;
+        printf(first ? "%d" : ", %d", p);
+        first = false;
+    }
+    printf("}");
+}
+
+// Validate string with step-by-step output
+bool validateString(DFA* dfa, const char* str) {
+    int current_state = dfa->start_state;
+
+    printf("\n  Initial state: %s\n", dfa->state_names[current_state]);
+    printf("  Transitions:\n");
+
+    for (int i = 0; str[i] != '\0'; i++) {
+        int cls = dfa->class_map[(unsigned char)str[i]];
+        int next_state = dfa->transition_table[current_state * dfa->num_classes + cls];
+        printf("    %s --(%c)--> %s",
+               dfa->state_names[current_state],
+               str[i],
+               dfa->state_names[next_state]);
+
+        if (dfa->accepting_states[next_state]) {
+            printf(" [accepting]");
+        } else if (next_state == dfa->dead_state) {
+            printf(" [dead]");
+        }
+        printf("\n");
+
+        current_state = next_state;
+    }
+
+    printf("  Final state: %s\n", dfa->state_names[current_state]);
+    bool accepted = dfa->accepting_states[current_state];
+    printf("  Result: %s\n", accepted ? "ACCEPTED" : "REJECTED");
+    if (dfa->num_patterns > 1) {
+        printf("  Matched patterns: ");
+        printAcceptSet(dfa, current_state);
+        printf("\n");
+    }
+
+    return accepted;
+}
+
+// Write a byte as a C constant: 'a' when printable, 0xHH otherwise
+static void writeCByte(FILE* file, int byte) {
+    if (byte > ' ' && byte < 127 && byte != '\'' && byte != '\\') {
+        fprintf(file, "'%c'", byte);
+    } else {
+        fprintf(file, "0x%02X", byte);
+    }
+}
+
+// Emit "goto sN;" for a live target, "return false;" for the dead state
+static void writeCJump(FILE* file, DFA* dfa, int target) {
+    if (target == dfa->dead_state) {
+        fprintf(file, "return false;");
+    } else {
+        fprintf(file, "goto s%d;", target);
+    }
+}
+
+// Generate a C matcher
+void generateCFile(DFA* dfa, const char* filename, const char* function_name) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        perror("Error creating C file");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "// Generated by the RE to DFA Converter; do not edit.\n");
+    fprintf(file, "// Matcher for: ");
+    for (const char* c = dfa->regex; *c; c++) {
+        fputc(*c == '\n' ? ' ' : *c, file);
+    }
+    fprintf(file, "\n// %d states; one labelled block per state, transitions as switch cases.\n\n",
+            dfa->num_states);
+    fprintf(file, "#include <stdbool.h>\n#include <stddef.h>\n\n");
+    fprintf(file, "bool %s(const char* str, size_t len) {\n", function_name);
+    fprintf(file, "    const unsigned char* p = (const unsigned char*)str;\n");
+    fprintf(file, "    const unsigned char* end = p + len;\n");
+    if (dfa->start_state == dfa->dead_state) {
+        fprintf(file, "    (void)p;\n    (void)end;\n    return false;\n}\n");
+        fclose(file);
+        return;
+    }
+    fprintf(file, "    goto s%d;\n", dfa->start_state);
+
+    int* count = xmalloc((size_t)dfa->num_states * sizeof(int));
+    for (int s = 0; s < dfa->num_states; s++) {
+        if (s == dfa->dead_state) continue;
+        const int* row = dfa->transition_table + (size_t)s * dfa->num_classes;
+
+        // The target reached by the most bytes becomes the default case
+        memset(count, 0, (size_t)dfa->num_states * sizeof(int));
+        int fallback = row[dfa->class_map[0]];
+        for (int b = 0; b < 256; b++) {
+            int target = row[dfa->class_map[b]];
+            if (++count[target] > count[fallback]) fallback = target;
+        }
+
+        fprintf(file, "\ns%d:\n", s);
+        fprintf(file, "    if (p == end) return %s;\n", dfa->accepting_states[s] ? "true" : "false");
+        fprintf(file, "    switch (*p++) {\n");
+        for (int t = 0; t < dfa->num_states; t++) {
+            if (t == fallback || count[t] == 0) continue;
+            int on_line = 0;
+            for (int b = 0; b < 256; b++) {
+                if (row[dfa->class_map[b]] != t) continue;
+                fprintf(file, on_line == 0 ? "        case " : " case ");
+                writeCByte(file, b);
+                fprintf(file, ":");
+                if (++on_line == 8) {
+                    fprintf(file, "\n");
+                    on_line = 0;
+                }
+            }
+            fprintf(file, on_line == 0 ? "            " : " ");
+            writeCJump(file, dfa, t);
+            fprintf(file, "\n");
+        }
+        fprintf(file, "        default: ");
+        writeCJump(file, dfa, fallback);
+        fprintf(file, "\n    }\n");
+    }
+    free(count);
+
+    fprintf(file, "}\n");
+    fclose(file);
+}
+
+// Print transition table
+void printTransitionTable(DFA* dfa) {
+    char label[8];
+
+    printf("DFA Transition Table:\n");
+    printf("  +-------+");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("-------+");
+    }
+    printf("\n");
+
+    printf("  | State |");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("   %-3s |", formatSymbol(dfa->symbols[i], label));
+    }
+    printf("\n");
+
+    printf("  +-------+");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("-------+");
+    }
+    printf("\n");
+
+    for (int i = 0; i < dfa->num_states; i++) {
+        if (dfa->accepting_states[i]) {
+            printf("  | *%-4s |", dfa->state_names[i]);
+        } else {
+            printf("  |  %-4s |", dfa->state_names[i]);
+        }
+
+        for (int j = 0; j < dfa->num_symbols; j++) {
+            int cls = dfa->class_map[(unsigned char)dfa->symbols[j]];
+            int next = dfa->transition_table[i * dfa->num_classes + cls];
+            if (dfa->accepting_states[next]) {
+                printf(" *%-4s|", dfa->state_names[next]);
+            } else {
+                printf("  %-4s|", dfa->state_names[next]);
+            }
+        }
+        printf("\n");
+    }
+
+    printf("  +-------+");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("-------+");
+    }
+    printf("\n");
+    printf("  (* denotes accepting state)\n\n");
+}
@@ -0,0 +1,92 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define STATE_NAME_LEN 16
+
+// Structure to represent a DFA
+// Input bytes are first mapped to an equivalence class (bytes that every
+// state treats the same share a class; bytes outside the alphabet share a
+// class that leads to the dead state). The transition table is row-major
+// with num_classes columns:
+//     next = transition_table[state * num_classes + class_map[byte]]
+// A DFA may recognise several patterns at once: accept_sets holds
+// accept_words 64-bit words per state, bit p set when pattern p matches
+// there, and accepting_states[s] is true when any bit is set.
+// All per-state arrays grow together.
+typedef struct {
+    int num_states;
+    int num_symbols;
+    char* symbols;
+    int num_classes;
+    unsigned char class_map[256];
+    int* transition_table;
+    int start_state;
+    int dead_state;
+    bool* accepting_states;
+    int num_patterns;
+    int accept_words;
+    uint64_t* accept_sets;
+    char (*state_names)[STATE_NAME_LEN];
+    char* regex;
+    int capacity;
+} DFA;
+
+// Allocation helpers (exit on out-of-memory)
+void* xmalloc(size_t size);
+void* xcalloc(size_t count, size_t size);
+void* xrealloc(void* ptr, size_t size);
+
+// Create an empty DFA over the given alphabet that recognises num_patterns
+// patterns. With class_map NULL each symbol gets its own class and all
+// other bytes share a final reject class.
+void initDFA(DFA* dfa, const char* regex, const char* symbols, int num_symbols,
+             const unsigned char* class_map, int num_classes, int num_patterns);
+
+// Release all memory owned by the DFA
+void freeDFA(DFA* dfa);
+
+// Append a new state (named q<n>) and return its index; accepting marks
+// it as accepting pattern 0
+int addState(DFA* dfa, bool accepting);
+
+// Mark state as accepting pattern
+void addAcceptingPattern(DFA* dfa, int state, int pattern);
+
+// Does state accept pattern?
+bool stateMatchesPattern(const DFA* dfa, int state, int pattern);
+
+// Accept set of state (accept_words words, bit p = pattern p)
+const uint64_t* stateAcceptSet(const DFA* dfa, int state);
+
+// Rebuild the DFA with old state s renumbered to state_map[s].
+// States mapped to -1 are dropped (nothing kept may lead to them);
+// states sharing a number must be equivalent, the first one's row is kept.
+void remapStates(DFA* dfa, const int* state_map, int new_count);
+
+// Index of the non-accepting state that loops to itself on every class,
+// or -1 if there is none
+int findDeadState(const DFA* dfa);
+
+// State reached after len bytes from the start state, without output
+int dfa_run(const DFA* dfa, const char* str, size_t len);
+
+// Silent acceptance test of len bytes: one table step per byte, no output
+bool dfa_accepts(const DFA* dfa, const char* str, size_t len);
+
+// Validate string with step-by-step output (opt-in trace of dfa_accepts)
+bool validateString(DFA* dfa, const char* str);
+
+// Generate a C source file defining
+//     bool function_name(const char* str, size_t len)
+// that matches like dfa_accepts, with the transitions compiled into a
+// switch/goto state machine instead of table lookups
+void generateCFile(DFA* dfa, const char* filename, const char* function_name);
+
+// Print transition table
+void printTransitionTable(DFA* dfa);
+
+#endif
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dfafile.h"
+
+// Round up to the section alignment
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+// Write size bytes at offset, zero-filling any gap before it
+static bool writeSection(FILE* file, uint64_t* position, uint64_t offset, const void* data, size_t size) {
+    static const char zeros[8] = {0};
+    while (*position < offset) {
+        size_t gap = (size_t)(offset - *position) < sizeof(zeros) ? (size_t)(offset - *position) : sizeof(zeros);
+        if (fwrite(zeros, 1, gap, file) != gap) return false;
+        *position += gap;
+    }
+    if (size > 0 && fwrite(data, 1, size, file) != size) return false;
+    *position += size;
+    return true;
+}
+
+// Write the DFA file
+bool saveDFA(const DFA* dfa, const char* path) {
+    uint64_t n = (uint64_t)dfa->num_states;
+    uint64_t k = (uint64_t)dfa->num_classes;
+
+    DFAFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DFA_FILE_MAGIC, sizeof(header.magic));
+    header.version = DFA_FILE_VERSION;
+    header.endian_check = DFA_FILE_ENDIAN_CHECK;
+    header.header_size = sizeof(DFAFileHeader);
+    header.num_states = (uint32_t)dfa->num_states;
+    header.num_classes = (uint32_t)dfa->num_classes;
+    header.num_symbols = (uint32_t)dfa->num_symbols;
+    header.start_state = dfa->start_state;
+    header.dead_state = dfa->dead_state;
+    header.name_len = STATE_NAME_LEN;
+    // Narrowest entry that holds every state number
+    uint64_t width = n <= 256 ? 1 : n <= 65536 ? 2 : 4;
+    header.table_width = (uint32_t)width;
+
+    size_t regex_len = strlen(dfa->regex) + 1;
+    header.regex_offset = align8(sizeof(DFAFileHeader));
+    header.symbols_offset = align8(header.regex_offset + regex_len);
+    header.class_map_offset = align8(header.symbols_offset + (uint64_t)dfa->num_symbols);
+    header.table_offset = align8(header.class_map_offset + 256);
+    header.accept_offset = align8(header.table_offset + n * k * width);
+    header.names_offset = align8(header.accept_offset + n);
+    header.file_size = header.names_offset + n * STATE_NAME_LEN;
+
+    // int and bool in memory differ from the file's table entries and
+    // bytes; names are NUL-padded so the file contents are reproducible
+    unsigned char* table = xmalloc((size_t)(n * k * width));
+    unsigned char* accept = xmalloc((size_t)n);
+    char* names = xcalloc((size_t)n, STATE_NAME_LEN);
+    for (uint64_t i = 0; i < n * k; i++) {
+        int target = dfa->transition_table[i];
+        if (width == 1) {
+            table[i] = (unsigned char)target;
+        } else if (width == 2) {
+            ((uint16_t*)table)[i] = (uint16_t)target;
+        } else {
+            ((int32_t*)table)[i] = target;
+        }
+    }
+    for (uint64_t s = 0; s < n; s++) {
+        accept[s] = dfa->accepting_states[s] ? 1 : 0;
+        strncpy(names + s * STATE_NAME_LEN, dfa->state_names[s], STATE_NAME_LEN - 1);
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        perror("Error creating DFA file");
+        free(table);
+        free(accept);
+        free(names);
+        return false;
+    }
+    uint64_t position = 0;
+    bool ok = writeSection(file, &position, 0, &header, sizeof(header))
+           && writeSection(file, &position, header.regex_offset, dfa->regex, regex_len)
+           && writeSection(file, &position, header.symbols_offset, dfa->symbols, (size_t)dfa->num_symbols)
+           && writeSection(file, &position, header.class_map_offset, dfa->class_map, 256)
+           && writeSection(file, &position, header.table_offset, table, (size_t)(n * k * width))
+           && writeSection(file, &position, header.accept_offset, accept, (size_t)n)
+           && writeSection(file, &position, header.names_offset, names, (size_t)n * STATE_NAME_LEN);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) perror("Error writing DFA file");
+
+    free(table);
+    free(accept);
+    free(names);
+    return ok;
+}
@@ -0,0 +1,56 @@
+#ifndef DFAFILE_H
+#define DFAFILE_H
+
+#include <stdint.h>
+#include "dfa.h"
+
+// Compiled DFA file format, version 2
+//
+// A .dfa file holds a minimized DFA ready to be mmap'ed read-only and used
+// in place: every section is stored in the layout the matcher indexes
+// directly, located by byte offset from the start of the file (so it does
+// not matter where the file is mapped), and 8-byte aligned.
+//
+//   DFAFileHeader
+//   regex           NUL-terminated pattern text
+//   symbols         num_symbols bytes (the alphabet, for display)
+//   class_map       256 bytes, byte -> class
+//   table           num_states * num_classes entries, row-major, each
+//                   table_width bytes: 1 (up to 256 states), 2 (up to
+//                   65536) or 4 (int32)
+//   accept          num_states bytes, 1 = accepting
+//   names           num_states * name_len bytes, NUL-padded state names
+//
+// Integers are in the writer's byte order; readers check endian_check and
+// reject files from a machine with the other order. Version 1 files are
+// identical except that every table entry is an int32 (table_width 0).
+#define DFA_FILE_MAGIC "TOCDFA\r\n"
+#define DFA_FILE_VERSION 2
+#define DFA_FILE_ENDIAN_CHECK 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_check;
+    uint32_t header_size;
+    uint32_t num_states;
+    uint32_t num_classes;
+    uint32_t num_symbols;
+    int32_t start_state;
+    int32_t dead_state;          // -1 if there is none
+    uint32_t name_len;
+    uint32_t table_width;        // bytes per table entry (version 2)
+    uint64_t file_size;
+    uint64_t regex_offset;
+    uint64_t symbols_offset;
+    uint64_t class_map_offset;
+    uint64_t table_offset;
+    uint64_t accept_offset;
+    uint64_t names_offset;
+} DFAFileHeader;
+
+// Write dfa to path in the format above; returns false (with perror)
+// on failure
+bool saveDFA(const DFA* dfa, const char* path);
+
+#endif
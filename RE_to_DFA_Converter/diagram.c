@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "diagram.h"
+
+// Printable label for an alphabet symbol (non-printable bytes as hex)
+static const char* formatSymbol(unsigned char symbol, char buf[8]) {
+    if (symbol > ' ' && symbol < 127) {
+        buf[0] = (char)symbol;
+        buf[1] = '\0';
+    } else {
+        snprintf(buf, 8, "0x%02X", symbol);
+    }
+    return buf;
+}
+
+// Label for the edge from -> to, with ranges for consecutive bytes
+int diagramEdgeLabel(const StateDiagram* d, int from, int to, char buf[DIAGRAM_LABEL_LEN]) {
+    bool in_alphabet[256] = { false };
+    for (int j = 0; j < d->num_symbols; j++) {
+        in_alphabet[(unsigned char)d->symbols[j]] = true;
+    }
+
+    int count = 0;
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int b = 0; b < 256; b++) {
+        if (!in_alphabet[b] || d->next(d->graph, from, (unsigned char)b) != to) continue;
+        int last = b;
+        while (last + 1 < 256 && in_alphabet[last + 1]
+               && d->next(d->graph, from, (unsigned char)(last + 1)) == to) {
+            last++;
+        }
+
+        char first_label[8], last_label[8];
+        const char* separator = count > 0 ? ", " : "";
+        formatSymbol((unsigned char)b, first_label);
+        formatSymbol((unsigned char)last, last_label);
+        if (last - b >= 2) {
+            used += snprintf(buf + used, DIAGRAM_LABEL_LEN - used, "%s%s-%s", separator, first_label, last_label);
+        } else if (last == b + 1) {
+            used += snprintf(buf + used, DIAGRAM_LABEL_LEN - used, "%s%s, %s", separator, first_label, last_label);
+        } else {
+            used += snprintf(buf + used, DIAGRAM_LABEL_LEN - used, "%s%s", separator, first_label);
+        }
+        count += last - b + 1;
+        b = last;
+    }
+    return count;
+}
+
+// Write a string into a DOT label, escaping quotes and backslashes
+static void writeDotEscaped(FILE* file, const char* text) {
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*text, file);
+    }
+}
+
+void writeDotDiagram(const StateDiagram* d, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        perror("Error creating DOT file");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "digraph DFA {\n");
+    fprintf(file, "    rankdir=LR;\n");
+    fprintf(file, "    graph [pad=\"0.5\", nodesep=\"1.2\", ranksep=\"2.0\", bgcolor=\"white\"];\n");
+    fprintf(file, "    node [fontname=\"Arial\", fontsize=14, style=filled, fillcolor=\"lightblue\"];\n");
+    fprintf(file, "    edge [fontname=\"Arial\", fontsize=12, arrowsize=0.8];\n");
+    fprintf(file, "    labelloc=\"t\";\n");
+    fprintf(file, "    label=\"DFA for Regular Expression: ");
+    writeDotEscaped(file, d->title);
+    fprintf(file, "\";\n");
+    fprintf(file, "    fontsize=18;\n");
+    fprintf(file, "    fontname=\"Arial Bold\";\n\n");
+
+    // Initial arrow
+    fprintf(file, "    node [shape=point, width=0]; start;\n");
+    fprintf(file, "    start -> %s [label=\"start\"];\n\n", d->state_name(d->graph, d->start_state));
+
+    // Define all states (the dead state and edges into it are left implicit)
+    char label[DIAGRAM_LABEL_LEN];
+    for (int i = 0; i < d->num_states; i++) {
+        if (i == d->dead_state) continue;
+        const char* name = d->state_name(d->graph, i);
+        label[0] = '\0';
+        if (d->accepting[i] && d->state_note) {
+            d->state_note(d->graph, i, label);
+        }
+        if (label[0]) {
+            fprintf(file, "    %s [shape=doublecircle, fixedsize=true, width=1.0, fillcolor=\"lightgreen\", label=\"%s\\n",
+                    name, name);
+            writeDotEscaped(file, label);
+            fprintf(file, "\"];\n");
+        } else if (d->accepting[i]) {
+            fprintf(file, "    %s [shape=doublecircle, fixedsize=true, width=1.0, fillcolor=\"lightgreen\"];\n",
+                    name);
+        } else {
+            fprintf(file, "    %s [shape=circle, fixedsize=true, width=1.0];\n",
+                    name);
+        }
+    }
+    fprintf(file, "\n");
+
+    // Add transitions, one edge per target state
+    int* emitted = malloc((size_t)(d->num_states ? d->num_states : 1) * sizeof(int));
+    if (!emitted) {
+        perror("Error allocating DOT edges");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < d->num_states; i++) {
+        emitted[i] = -1;
+    }
+    for (int i = 0; i < d->num_states; i++) {
+        if (i == d->dead_state) continue;
+        for (int j = 0; j < d->num_symbols; j++) {
+            int next_state = d->next(d->graph, i, (unsigned char)d->symbols[j]);
+            if (next_state == d->dead_state || emitted[next_state] == i) continue;
+            emitted[next_state] = i;
+
+            diagramEdgeLabel(d, i, next_state, label);
+            fprintf(file, "    %s -> %s [label=\"",
+                    d->state_name(d->graph, i),
+                    d->state_name(d->graph, next_state));
+            writeDotEscaped(file, label);
+
+            // Check if this is a self-loop
+            if (i == next_state) {
+                fprintf(file, "\", style=bold];\n");
+            } else {
+                fprintf(file, "\"];\n");
+            }
+        }
+    }
+    free(emitted);
+
+    fprintf(file, "}\n");
+    fclose(file);
+}
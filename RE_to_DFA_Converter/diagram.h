@@ -0,0 +1,41 @@
+#ifndef DIAGRAM_H
+#define DIAGRAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Room for any edge label or state note: 256 symbols of up to 6
+// characters each
+#define DIAGRAM_LABEL_LEN 1600
+
+// A state diagram to draw, described through callbacks so the same writers
+// serve any transition table representation. The converter and the
+// validator each fill one in from their DFA (see their graph.c).
+typedef struct {
+    const void* graph;             // passed back to every callback
+    int num_states;
+    int start_state;
+    int dead_state;                // not drawn, nor edges into it
+    const char* symbols;           // alphabet the edges are followed on
+    int num_symbols;
+    const bool* accepting;         // per state
+    const char* title;             // shown after "DFA for Regular Expression: "
+
+    // State reached from state on symbol
+    int (*next)(const void* graph, int state, unsigned char symbol);
+    // Name drawn inside state
+    const char* (*state_name)(const void* graph, int state);
+    // Note drawn below an accepting state, empty for none; may be NULL
+    void (*state_note)(const void* graph, int state, char note[DIAGRAM_LABEL_LEN]);
+} StateDiagram;
+
+// Label for the edge from -> to: the symbols taking that transition in
+// byte order, with runs of three or more consecutive bytes written as a
+// range, e.g. "0-9, _, a-z". Returns the number of symbols (0: no edge).
+int diagramEdgeLabel(const StateDiagram* diagram, int from, int to, char label[DIAGRAM_LABEL_LEN]);
+
+// Write the diagram as a Graphviz DOT file, one edge per state pair
+// labelled by diagramEdgeLabel. Exits if the file cannot be created.
+void writeDotDiagram(const StateDiagram* diagram, const char* filename);
+
+#endif
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include "graph.h"
+#include "svglayout.h"
+
+static int graphNext(const void* graph, int state, unsigned char symbol) {
+    const DFA* dfa = graph;
+    return dfa->transition_table[state * dfa->num_classes + dfa->class_map[symbol]];
+}
+
+static const char* graphStateName(const void* graph, int state) {
+    const DFA* dfa = graph;
+    return dfa->state_names[state];
+}
+
+// Pattern IDs an accepting state reports, e.g. "#0,2" (pattern sets only)
+static void graphStateNote(const void* graph, int state, char note[DIAGRAM_LABEL_LEN]) {
+    const DFA* dfa = graph;
+    int len = 0;
+    note[0] = '\0';
+    if (dfa->num_patterns <= 1) return;
+    for (int p = 0; p < dfa->num_patterns && len < DIAGRAM_LABEL_LEN - 16; p++) {
+        if (!stateMatchesPattern(dfa, state, p)) continue;
+        len += snprintf(note + len, DIAGRAM_LABEL_LEN - len, len == 0 ? "#%d" : ",%d", p);
+    }
+}
+
+static StateDiagram dfaDiagram(const DFA* dfa) {
+    StateDiagram diagram = {
+        .graph = dfa,
+        .num_states = dfa->num_states,
+        .start_state = dfa->start_state,
+        .dead_state = dfa->dead_state,
+        .symbols = dfa->symbols,
+        .num_symbols = dfa->num_symbols,
+        .accepting = dfa->accepting_states,
+        .title = dfa->regex,
+        .next = graphNext,
+        .state_name = graphStateName,
+        .state_note = graphStateNote,
+    };
+    return diagram;
+}
+
+void generateDotFile(DFA* dfa, const char* filename) {
+    StateDiagram diagram = dfaDiagram(dfa);
+    writeDotDiagram(&diagram, filename);
+}
+
+void generateSvgFile(DFA* dfa, const char* filename) {
+    StateDiagram diagram = dfaDiagram(dfa);
+    writeSvgDiagram(&diagram, filename);
+}
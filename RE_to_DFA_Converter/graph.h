@@ -0,0 +1,18 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "dfa.h"
+
+// Diagrams of the DFA, drawn by the shared writers of diagram.h and
+// svglayout.h. Edges are labelled by diagramEdgeLabel, and accepting
+// states of a pattern set are annotated with the pattern IDs they report.
+// The dead state and edges into it are omitted.
+
+// Generate Graphviz DOT file (one edge per state pair)
+void generateDotFile(DFA* dfa, const char* filename);
+
+// Draw the DFA as a standalone SVG image, in process (no Graphviz), with
+// the layered layout of writeSvgDiagram
+void generateSvgFile(DFA* dfa, const char* filename);
+
+#endif
@@ -2,286 +2,757 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <ctype.h>
+#include <time.h>
+#include "dfa.h"
+#include "regex.h"
+#include "minimize.h"
+#include "lazy.h"
+#include "dfafile.h"
+#include "stream.h"
+#include "lexer.h"
+#include "profile.h"
+#include "graph.h"
+#include "comb.h"
+#include "bitnfa.h"
 
-#define MAX_STATES 20
-#define MAX_SYMBOLS 10
-
-// Structure to represent a DFA
-typedef struct {
-    int num_states;
-    int num_symbols;
-    char symbols[MAX_SYMBOLS];
-    int transition_table[MAX_STATES][MAX_SYMBOLS];
-    int start_state;
-    bool accepting_states[MAX_STATES];
-    char state_names[MAX_STATES][20];
-    char regex[100];
-} DFA;
-
-// Initialize DFA for RE = (a|b)*abb
-void initDFA_Pattern_abb(DFA* dfa) {
-    strcpy(dfa->regex, "(a|b)*abb");
-    dfa->num_states = 4;
-    dfa->num_symbols = 2;
-    dfa->symbols[0] = 'a';
-    dfa->symbols[1] = 'b';
-    dfa->start_state = 0;
-    
-    // State names
-    strcpy(dfa->state_names[0], "q0");
-    strcpy(dfa->state_names[1], "q1");
-    strcpy(dfa->state_names[2], "q2");
-    strcpy(dfa->state_names[3], "q3");
-    
-    // Accepting states
-    dfa->accepting_states[0] = false;
-    dfa->accepting_states[1] = false;
-    dfa->accepting_states[2] = false;
-    dfa->accepting_states[3] = true;  // q3 is accepting state
-    
-    // Transition table for (a|b)*abb
-    // State 0: q0 (initial state)
-    dfa->transition_table[0][0] = 1;  // q0 --a--> q1
-    dfa->transition_table[0][1] = 0;  // q0 --b--> q0
-    
-    // State 1: q1 (after reading 'a')
-    dfa->transition_table[1][0] = 1;  // q1 --a--> q1
-    dfa->transition_table[1][1] = 2;  // q1 --b--> q2
-    
-    // State 2: q2 (after reading 'ab')
-    dfa->transition_table[2][0] = 1;  // q2 --a--> q1
-    dfa->transition_table[2][1] = 3;  // q2 --b--> q3
-    
-    // State 3: q3 (accepting state - after reading 'abb')
-    dfa->transition_table[3][0] = 1;  // q3 --a--> q1
-    dfa->transition_table[3][1] = 0;  // q3 --b--> q0
-}
+// Tables/diagrams beyond this size are only written to file
+#define MAX_PRINTED_STATES 64
+#define MAX_PRINTED_SYMBOLS 16
 
-// Get symbol index
-int getSymbolIndex(DFA* dfa, char symbol) {
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        if (dfa->symbols[i] == symbol) {
-            return i;
+// Print state descriptions
+void printStateDescriptions(DFA* dfa) {
+    printf("\nState Descriptions:\n");
+    for (int i = 0; i < dfa->num_states; i++) {
+        printf("  %s:", dfa->state_names[i]);
+        if (i == dfa->start_state) {
+            printf(" Initial state");
+        }
+        if (dfa->accepting_states[i]) {
+            printf(" ACCEPTING STATE");
         }
+        if (i == dfa->dead_state) {
+            printf(" Dead state (input can no longer match)");
+        }
+        printf("\n");
     }
-    return -1;
+    printf("\n");
 }
 
-// Validate string with step-by-step output
-bool validateString(DFA* dfa, const char* str) {
-    int current_state = dfa->start_state;
-    
-    printf("\n  Initial state: %s\n", dfa->state_names[current_state]);
-    printf("  Transitions:\n");
-    
-    for (int i = 0; str[i] != '\0'; i++) {
-        int symbol_idx = getSymbolIndex(dfa, str[i]);
-        if (symbol_idx == -1) {
-            printf("  Invalid character '%c' in input\n", str[i]);
-            return false;
+// Print the pattern IDs in state's accept set
+static void printMatchedPatterns(const DFA* dfa, int state) {
+    bool first = true;
+    for (int p = 0; p < dfa->num_patterns; p++) {
+        if (!stateMatchesPattern(dfa, state, p)) continue;
+        printf(first ? "%d" : ", %d", p);
+        first = false;
+    }
+    if (first) printf("none");
+}
+
+// Print the bytes each transition table representation takes and select
+// one (see selectCombTable); returns true (with comb built) when the comb
+// table is used, the smallest of the three. A comb table that loses is
+// not built, so only its lower bound is shown.
+static bool selectTableLayout(const DFA* dfa, CombTable* comb) {
+    bool compressed = selectCombTable(dfa, comb);
+
+    printf("\nTransition Table Storage (%.1f%% of transitions stored explicitly):\n",
+           100.0 * transitionDensity(dfa));
+    printf("  Dense, int entries:    %10zu bytes%s\n", denseTableBytes(dfa),
+           compressed ? "" : "  <- used");
+    printf("  Dense, narrow entries: %10zu bytes (.dfa files)\n", narrowTableBytes(dfa));
+    if (compressed) {
+        printf("  Comb vector:           %10zu bytes  <- used\n", combTableBytes(comb));
+    } else {
+        size_t least = combTableMinBytes(dfa);
+        if (least < narrowTableBytes(dfa)) least = narrowTableBytes(dfa);
+        printf("  Comb vector:           %10zu bytes or more (not built)\n", least);
+    }
+    return compressed;
+}
+
+// Strip a trailing newline (and '\r') in place
+static void chomp(char* line) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+}
+
+// Compile every pattern in a file (one per line) into one DFA and report,
+// for each string, all patterns that match it in a single scan. Strings
+// come from the command line, or from standard input when none are given.
+int runPatternSet(const char* path, char** strings, int num_strings) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror("Error opening pattern file");
+        return EXIT_FAILURE;
+    }
+    char** patterns = NULL;
+    int num_patterns = 0, capacity = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        chomp(line);
+        if (line[0] == '\0') continue;
+        if (num_patterns == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            patterns = xrealloc(patterns, (size_t)capacity * sizeof(char*));
         }
-        
-        int next_state = dfa->transition_table[current_state][symbol_idx];
-        printf("    %s --(%c)--> %s", 
-               dfa->state_names[current_state], 
-               str[i], 
-               dfa->state_names[next_state]);
-        
-        if (dfa->accepting_states[next_state]) {
-            printf(" [accepting]");
+        patterns[num_patterns] = xmalloc(strlen(line) + 1);
+        strcpy(patterns[num_patterns++], line);
+    }
+    fclose(file);
+
+    DFA dfa;
+    char error[512];
+    bool ok = compilePatternSet((const char* const*)patterns, num_patterns, &dfa, error, sizeof(error));
+    if (ok) {
+        MinimizeReport report;
+        minimizeDFA(&dfa, &report);
+
+        printf("========================================\n");
+        printf("Multi-Pattern DFA\n");
+        printf("========================================\n");
+        for (int p = 0; p < num_patterns; p++) {
+            printf("  [%d] %s\n", p, patterns[p]);
         }
-        printf("\n");
-        
-        current_state = next_state;
-    }
-    
-    printf("  Final state: %s\n", dfa->state_names[current_state]);
-    bool accepted = dfa->accepting_states[current_state];
-    printf("  Result: %s\n", accepted ? "ACCEPTED" : "REJECTED");
-    
-    return accepted;
+        printf("\nStates: %d (%d before minimization), %d byte classes\n",
+               dfa.num_states, report.states_before, dfa.num_classes);
+        CombTable comb;
+        bool compressed = selectTableLayout(&dfa, &comb);
+
+        printf("\n========================================\n");
+        printf("Matches (one scan per string)\n");
+        printf("========================================\n");
+        for (int i = 0; num_strings == 0 || i < num_strings; i++) {
+            const char* str = strings[i];
+            if (num_strings == 0) {
+                if (!fgets(line, sizeof(line), stdin)) break;
+                chomp(line);
+                str = line;
+            }
+            int state = compressed
+                ? comb_run(&comb, dfa.class_map, dfa.start_state, str, strlen(str))
+                : dfa_run(&dfa, str, strlen(str));
+            printf("  '%s': ", str);
+            printMatchedPatterns(&dfa, state);
+            printf("\n");
+        }
+        if (compressed) freeCombTable(&comb);
+        freeDFA(&dfa);
+    } else {
+        fprintf(stderr, "✗ Error: %s\n", error);
+    }
+
+    for (int p = 0; p < num_patterns; p++) {
+        free(patterns[p]);
+    }
+    free(patterns);
+    return ok ? 0 : EXIT_FAILURE;
 }
 
-// Generate Graphviz DOT file
-void generateDotFile(DFA* dfa, const char* filename) {
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        perror("Error creating DOT file");
-        exit(EXIT_FAILURE);
-    }
-    
-    fprintf(file, "digraph DFA {\n");
-    fprintf(file, "    rankdir=LR;\n");
-    fprintf(file, "    graph [pad=\"0.5\", nodesep=\"1.2\", ranksep=\"2.0\", bgcolor=\"white\"];\n");
-    fprintf(file, "    node [fontname=\"Arial\", fontsize=14, style=filled, fillcolor=\"lightblue\"];\n");
-    fprintf(file, "    edge [fontname=\"Arial\", fontsize=12, arrowsize=0.8];\n");
-    fprintf(file, "    labelloc=\"t\";\n");
-    fprintf(file, "    label=\"DFA for Regular Expression: %s\";\n", dfa->regex);
-    fprintf(file, "    fontsize=18;\n");
-    fprintf(file, "    fontname=\"Arial Bold\";\n\n");
-    
-    // Initial arrow
-    fprintf(file, "    node [shape=point, width=0]; start;\n");
-    fprintf(file, "    start -> %s [label=\"start\"];\n\n", dfa->state_names[dfa->start_state]);
-    
-    // Define all states
-    for (int i = 0; i < dfa->num_states; i++) {
-        if (dfa->accepting_states[i]) {
-            fprintf(file, "    %s [shape=doublecircle, fixedsize=true, width=1.0, fillcolor=\"lightgreen\"];\n", 
-                    dfa->state_names[i]);
-        } else {
-            fprintf(file, "    %s [shape=circle, fixedsize=true, width=1.0];\n", 
-                    dfa->state_names[i]);
+// Match strings with a lazily built DFA and report its cache counters.
+// Strings come from the command line, or one per line from standard input
+// (only totals are printed then).
+int runLazy(const char* pattern, size_t cache_bytes, char** strings, int num_strings) {
+    LazyDFA lazy;
+    char error[256];
+    if (!compileLazy(pattern, cache_bytes, &lazy, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    printf("========================================\n");
+    printf("Lazy DFA: %s\n", pattern);
+    printf("========================================\n");
+    printf("Positions: %d, byte classes: %d\n", lazy.pa.num_positions, lazy.pa.num_classes);
+    printf("Cache: %zu KB (%d states)\n\n", cache_bytes / 1024, lazy.max_states);
+
+    if (num_strings > 0) {
+        for (int i = 0; i < num_strings; i++) {
+            bool accepted = lazy_accepts(&lazy, strings[i], strlen(strings[i]));
+            printf("  '%s': %s\n", strings[i], accepted ? "ACCEPTED ✓" : "REJECTED ✗");
         }
+    } else {
+        size_t buffer_size = 1 << 20;
+        char* line = xmalloc(buffer_size);
+        size_t lines = 0, accepted = 0;
+        while (fgets(line, (int)buffer_size, stdin)) {
+            chomp(line);
+            lines++;
+            if (lazy_accepts(&lazy, line, strlen(line))) accepted++;
+        }
+        free(line);
+        printf("  Strings: %zu, Accepted: %zu, Rejected: %zu\n", lines, accepted, lines - accepted);
     }
-    fprintf(file, "\n");
-    
-    // Add transitions
-    for (int i = 0; i < dfa->num_states; i++) {
-        for (int j = 0; j < dfa->num_symbols; j++) {
-            int next_state = dfa->transition_table[i][j];
-            
-            // Check if this is a self-loop
-            if (i == next_state) {
-                fprintf(file, "    %s -> %s [label=\"%c\", style=bold];\n",
-                        dfa->state_names[i],
-                        dfa->state_names[next_state],
-                        dfa->symbols[j]);
+
+    size_t steps = lazy.stats.hits + lazy.stats.misses;
+    printf("\nCache statistics:\n");
+    printf("  Hits:    %zu (%.2f%%)\n", lazy.stats.hits,
+           steps ? 100.0 * lazy.stats.hits / steps : 0.0);
+    printf("  Misses:  %zu (states built on demand)\n", lazy.stats.misses);
+    printf("  Flushes: %zu\n", lazy.stats.flushes);
+    printf("  Cached states: %d now, %d peak\n", lazyCachedStates(&lazy), lazy.stats.peak_states);
+
+    freeLazyDFA(&lazy);
+    return 0;
+}
+
+// One-shot matching: strings are tested with the engine that is cheapest
+// to build. Patterns whose position automaton fits in a machine word run
+// on the bit-parallel NFA; larger ones are compiled into a DFA (not
+// minimized, as it is used only once). Strings come from the command line
+// (traced step by step), or one per line from standard input (totals only).
+int runMatch(const char* pattern, char** strings, int num_strings) {
+    PositionAutomaton pa;
+    char error[256];
+    if (!buildPositions(&pattern, 1, &pa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+    BitNFA nfa;
+    DFA dfa;
+    int num_positions = pa.num_positions;
+    bool bit_parallel = initBitNFA(&nfa, &pa);
+    freePositions(&pa);
+    if (!bit_parallel && !compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    printf("========================================\n");
+    printf("Match: %s\n", pattern);
+    printf("========================================\n");
+    if (bit_parallel) {
+        printf("Engine: bit-parallel NFA (%d positions, %d follow table%s)\n",
+               num_positions, nfa.num_chunks, nfa.num_chunks == 1 ? "" : "s");
+    } else {
+        printf("Engine: DFA (%d positions exceed %d; %d states)\n",
+               num_positions, BITNFA_MAX_POSITIONS, dfa.num_states);
+    }
+
+    if (num_strings > 0) {
+        for (int i = 0; i < num_strings; i++) {
+            printf("\n[Test %d] String: '%s'\n", i + 1, strings[i]);
+            printf("----------------------------------------\n");
+            if (bit_parallel) {
+                validateBitNFA(&nfa, strings[i]);
             } else {
-                fprintf(file, "    %s -> %s [label=\"%c\"];\n",
-                        dfa->state_names[i],
-                        dfa->state_names[next_state],
-                        dfa->symbols[j]);
+                validateString(&dfa, strings[i]);
             }
         }
+    } else {
+        size_t buffer_size = 1 << 20;
+        char* line = xmalloc(buffer_size);
+        size_t lines = 0, accepted = 0;
+        while (fgets(line, (int)buffer_size, stdin)) {
+            chomp(line);
+            size_t len = strlen(line);
+            lines++;
+            accepted += bit_parallel ? bitnfa_accepts(&nfa, line, len) : dfa_accepts(&dfa, line, len);
+        }
+        free(line);
+        printf("  Strings: %zu, Accepted: %zu, Rejected: %zu\n", lines, accepted, lines - accepted);
     }
-    
-    fprintf(file, "}\n");
-    fclose(file);
+
+    if (bit_parallel) {
+        freeBitNFA(&nfa);
+    } else {
+        freeDFA(&dfa);
+    }
+    return 0;
 }
 
-// Print transition table
-void printTransitionTable(DFA* dfa) {
-    printf("DFA Transition Table:\n");
-    printf("  +-------+");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("-------+");
+// Compile and minimize pattern, then write it as a .dfa file
+int runSave(const char* path, const char* pattern) {
+    DFA dfa;
+    char error[256];
+    if (!compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
     }
-    printf("\n");
-    
-    printf("  | State |");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("   %c   |", dfa->symbols[i]);
+    MinimizeReport report;
+    minimizeDFA(&dfa, &report);
+
+    bool ok = saveDFA(&dfa, path);
+    if (ok) {
+        printf("✓ Saved DFA for '%s' to '%s' (%d states, %d byte classes)\n",
+               dfa.regex, path, dfa.num_states, dfa.num_classes);
     }
-    printf("\n");
-    
-    printf("  +-------+");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("-------+");
+    freeDFA(&dfa);
+    return ok ? 0 : EXIT_FAILURE;
+}
+
+// Compile and minimize pattern, then write it as a C matcher
+int runEmitC(const char* path, const char* pattern, const char* function_name) {
+    if (!isalpha((unsigned char)function_name[0]) && function_name[0] != '_') {
+        fprintf(stderr, "✗ Error: '%s' is not a valid C function name\n", function_name);
+        return EXIT_FAILURE;
     }
-    printf("\n");
-    
-    for (int i = 0; i < dfa->num_states; i++) {
-        if (dfa->accepting_states[i]) {
-            printf("  | *%-4s |", dfa->state_names[i]);
-        } else {
-            printf("  |  %-4s |", dfa->state_names[i]);
+    for (const char* c = function_name; *c; c++) {
+        if (!isalnum((unsigned char)*c) && *c != '_') {
+            fprintf(stderr, "✗ Error: '%s' is not a valid C function name\n", function_name);
+            return EXIT_FAILURE;
         }
-        
-        for (int j = 0; j < dfa->num_symbols; j++) {
-            int next = dfa->transition_table[i][j];
-            if (dfa->accepting_states[next]) {
-                printf(" *%-4s|", dfa->state_names[next]);
-            } else {
-                printf("  %-4s|", dfa->state_names[next]);
+    }
+
+    DFA dfa;
+    char error[256];
+    if (!compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+    MinimizeReport report;
+    minimizeDFA(&dfa, &report);
+
+    generateCFile(&dfa, path, function_name);
+    printf("✓ Wrote matcher %s() for '%s' to '%s' (%d states)\n",
+           function_name, dfa.regex, path, dfa.num_states);
+    freeDFA(&dfa);
+    return 0;
+}
+
+static void printStreamMatch(void* user, size_t start, size_t end) {
+    (void)user;
+    printf("%zu %zu\n", start, end);
+}
+
+// Search a file (or standard input) for pattern, reading it in fixed-size
+// chunks; prints "start end" byte offsets for each match
+int runSearch(const char* pattern, StreamMode mode, const char* path) {
+    DFA dfa;
+    char error[256];
+    if (!compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+    MinimizeReport report;
+    minimizeDFA(&dfa, &report);
+
+    FILE* input = path ? fopen(path, "rb") : stdin;
+    if (!input) {
+        perror("Error opening input");
+        freeDFA(&dfa);
+        return EXIT_FAILURE;
+    }
+
+    DFAStream stream;
+    initDFAStream(&stream, &dfa, mode, printStreamMatch, NULL);
+    size_t buffer_size = 1 << 16;
+    char* buffer = xmalloc(buffer_size);
+    size_t total = 0, n;
+    while ((n = fread(buffer, 1, buffer_size, input)) > 0) {
+        dfa_stream_feed(&stream, buffer, n);
+        total += n;
+    }
+    dfa_stream_finish(&stream);
+    fprintf(stderr, "%zu matches (%s) in %zu bytes\n", stream.matches,
+            mode == STREAM_EARLIEST ? "earliest" : "leftmost-longest", total);
+
+    free(buffer);
+    freeDFAStream(&stream);
+    if (path) fclose(input);
+    freeDFA(&dfa);
+    return 0;
+}
+
+// Print token text on one line, escaping control characters
+static void printTokenText(const char* text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '\n') printf("\\n");
+        else if (c == '\t') printf("\\t");
+        else if (c == '\\') printf("\\\\");
+        else if (c < 0x20 || c >= 0x7f) printf("\\x%02x", c);
+        else putchar(c);
+    }
+}
+
+// Tokenize a file (or standard input) with the rules in rules_path, one
+// "NAME regex" per line; matches of rules named "skip" are dropped.
+// Prints "offset length NAME text" for each token.
+int runLex(const char* rules_path, const char* input_path) {
+    FILE* file = fopen(rules_path, "r");
+    if (!file) {
+        perror("Error opening rules file");
+        return EXIT_FAILURE;
+    }
+    LexRule* rules = NULL;
+    char** names = NULL;
+    int num_rules = 0, capacity = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        chomp(line);
+        char* pattern = line + strcspn(line, " \t");
+        if (line[0] == '\0' || *pattern == '\0') continue;
+        *pattern++ = '\0';
+        pattern += strspn(pattern, " \t");
+        if (num_rules == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            rules = xrealloc(rules, (size_t)capacity * sizeof(LexRule));
+            names = xrealloc(names, (size_t)capacity * sizeof(char*));
+        }
+        names[num_rules] = xmalloc(strlen(line) + strlen(pattern) + 2);
+        strcpy(names[num_rules], line);
+        char* pattern_copy = names[num_rules] + strlen(line) + 1;
+        strcpy(pattern_copy, pattern);
+        rules[num_rules].pattern = pattern_copy;
+        rules[num_rules].token_id = strcmp(line, "skip") == 0 ? LEX_SKIP : num_rules;
+        num_rules++;
+    }
+    fclose(file);
+
+    Lexer lexer;
+    char error[512];
+    bool ok = num_rules > 0 && compileLexer(rules, num_rules, &lexer, error, sizeof(error));
+    if (!ok) {
+        fprintf(stderr, "✗ Error: %s\n", num_rules > 0 ? error : "no rules");
+    }
+
+    FILE* input = ok ? (input_path ? fopen(input_path, "rb") : stdin) : NULL;
+    if (ok && !input) {
+        perror("Error opening input");
+        freeLexer(&lexer);
+        ok = false;
+    }
+    if (ok) {
+        // Tokens point into the input, so it is read whole
+        size_t size = 0, buffer_size = 1 << 16, n;
+        char* buffer = xmalloc(buffer_size);
+        while ((n = fread(buffer + size, 1, buffer_size - size, input)) > 0) {
+            size += n;
+            if (size == buffer_size) {
+                buffer_size *= 2;
+                buffer = xrealloc(buffer, buffer_size);
             }
         }
-        printf("\n");
+        if (input_path) fclose(input);
+
+        Token tokens[1024];
+        size_t offset = 0, count = 0, errors = 0;
+        while (offset < size) {
+            size_t got = lexBuffer(&lexer, buffer, size, &offset, tokens, 1024);
+            for (size_t t = 0; t < got; t++) {
+                const char* name = tokens[t].id == LEX_ERROR ? "error" : names[tokens[t].id];
+                if (tokens[t].id == LEX_ERROR) errors++;
+                printf("%zu %zu %s ", tokens[t].offset, tokens[t].length, name);
+                printTokenText(buffer + tokens[t].offset, tokens[t].length);
+                printf("\n");
+            }
+            count += got;
+        }
+        fprintf(stderr, "%zu tokens (%zu errors) in %zu bytes, %d rules, %d states\n",
+                count, errors, size, num_rules, lexer.dfa.num_states);
+        free(buffer);
+        freeLexer(&lexer);
     }
-    
-    printf("  +-------+");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("-------+");
+
+    for (int r = 0; r < num_rules; r++) {
+        free(names[r]);
     }
-    printf("\n");
-    printf("  (* denotes accepting state)\n\n");
+    free(names);
+    free(rules);
+    return ok ? 0 : EXIT_FAILURE;
 }
 
-// Print state descriptions
-void printStateDescriptions(DFA* dfa) {
-    printf("\nState Descriptions:\n");
-    printf("  q0: Initial state - no pattern matched yet\n");
-    printf("  q1: After reading 'a' - first character of 'abb'\n");
-    printf("  q2: After reading 'ab' - two characters of 'abb'\n");
-    printf("  q3: After reading 'abb' - ACCEPTING STATE (complete pattern)\n\n");
+// Run dfa over every sample string until at least 0.2 s of CPU time has
+// passed; returns seconds per pass and sets *accepted
+static double timeSamples(const DFA* dfa, char** strings, const size_t* lengths,
+                          size_t num_strings, size_t* accepted) {
+    int passes = 0;
+    clock_t start = clock();
+    do {
+        *accepted = 0;
+        for (size_t i = 0; i < num_strings; i++) {
+            *accepted += dfa_accepts(dfa, strings[i], lengths[i]);
+        }
+        passes++;
+    } while (clock() - start < CLOCKS_PER_SEC / 5);
+    return (double)(clock() - start) / CLOCKS_PER_SEC / passes;
 }
 
-int main() {
+// Print simulated cache and timing figures for one state numbering
+static void printLayoutFigures(const char* label, const DFA* dfa, char** strings,
+                               const size_t* lengths, size_t num_strings, size_t bytes,
+                               size_t* accepted) {
+    CacheSimResult cache;
+    simulateTableCache(dfa, (const char* const*)strings, lengths, num_strings, &cache);
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        double t = timeSamples(dfa, strings, lengths, num_strings, accepted);
+        if (t < best) best = t;
+    }
+    printf("  %-10s %10llu %7.3f%% %10llu %9.3f %9.1f\n", label,
+           (unsigned long long)cache.misses,
+           cache.accesses ? 100.0 * cache.misses / cache.accesses : 0.0,
+           (unsigned long long)cache.lines_touched,
+           bytes ? best * 1e9 / bytes : 0.0, best > 0 ? bytes / best / 1e6 : 0.0);
+}
+
+// Profile pattern's DFA on sample strings (one per line of sample_path),
+// renumber its states by the profile and compare the two layouts;
+// optionally save the renumbered DFA
+int runProfile(const char* pattern, const char* sample_path, const char* save_path) {
     DFA dfa;
-    initDFA_Pattern_abb(&dfa);
-    
+    char error[256];
+    if (!compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+    MinimizeReport report;
+    minimizeDFA(&dfa, &report);
+
+    FILE* file = fopen(sample_path, "r");
+    if (!file) {
+        perror("Error opening sample file");
+        freeDFA(&dfa);
+        return EXIT_FAILURE;
+    }
+    char** strings = NULL;
+    size_t* lengths = NULL;
+    size_t num_strings = 0, capacity = 0, bytes = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        chomp(line);
+        if (num_strings == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            strings = xrealloc(strings, capacity * sizeof(char*));
+            lengths = xrealloc(lengths, capacity * sizeof(size_t));
+        }
+        lengths[num_strings] = strlen(line);
+        strings[num_strings] = xmalloc(lengths[num_strings] + 1);
+        memcpy(strings[num_strings], line, lengths[num_strings] + 1);
+        bytes += lengths[num_strings++];
+    }
+    fclose(file);
+
+    DFAProfile profile;
+    initProfile(&profile, &dfa);
+    for (size_t i = 0; i < num_strings; i++) {
+        dfa_run_profiled(&dfa, strings[i], lengths[i], &profile);
+    }
+
+    printf("========================================\n");
+    printf("Profile-Guided State Numbering: %.60s%s\n", dfa.regex, strlen(dfa.regex) > 60 ? "..." : "");
+    printf("========================================\n");
+    printf("Sample: %s (%zu strings, %zu bytes)\n", sample_path, num_strings, bytes);
+    printf("DFA: %d states, %d byte classes, %zu KB table\n", dfa.num_states, dfa.num_classes,
+           (size_t)dfa.num_states * dfa.num_classes * sizeof(int) / 1024);
+
+    // The five hottest transitions
+    int k = dfa.num_classes;
+    size_t slots = (size_t)dfa.num_states * k;
+    size_t hottest[5];
+    int num_hottest = 0;
+    for (size_t slot = 0; slot < slots; slot++) {
+        if (profile.hits[slot] == 0) continue;
+        int i = num_hottest < 5 ? num_hottest++ : 5;
+        while (i > 0 && profile.hits[hottest[i - 1]] < profile.hits[slot]) {
+            if (i < 5) hottest[i] = hottest[i - 1];
+            i--;
+        }
+        if (i < 5) hottest[i] = slot;
+    }
+    printf("\nHottest transitions:\n");
+    for (int h = 0; h < num_hottest; h++) {
+        int s = (int)(hottest[h] / k), c = (int)(hottest[h] % k);
+        int b = 0;
+        while (b < 256 && dfa.class_map[b] != c) b++;
+        char symbol[8];
+        snprintf(symbol, sizeof(symbol), b > ' ' && b < 127 ? "%c" : "0x%02X", b);
+        printf("  %-6s --%s--> %-6s %6.2f%%\n", dfa.state_names[s], symbol,
+               dfa.state_names[dfa.transition_table[hottest[h]]],
+               100.0 * profile.hits[hottest[h]] / profile.bytes);
+    }
+
+    printf("\nSimulated %d KB %d-way cache, %d-byte lines; best of 3 timings\n\n",
+           SIM_CACHE_BYTES / 1024, SIM_CACHE_WAYS, SIM_CACHE_LINE);
+    printf("  %-10s %10s %8s %10s %9s %9s\n", "Numbering", "Misses", "Rate", "Lines", "ns/byte", "MB/s");
+    size_t accepted_before, accepted_after;
+    printLayoutFigures("BFS", &dfa, strings, lengths, num_strings, bytes, &accepted_before);
+    renumberByProfile(&dfa, &profile);
+    printLayoutFigures("profile", &dfa, strings, lengths, num_strings, bytes, &accepted_after);
+
+    int status = 0;
+    if (accepted_before != accepted_after) {
+        fprintf(stderr, "✗ Error: renumbered DFA accepts %zu strings, original %zu\n",
+                accepted_after, accepted_before);
+        status = EXIT_FAILURE;
+    } else {
+        printf("\nAccepted: %zu of %zu strings (same for both numberings)\n",
+               accepted_after, num_strings);
+    }
+    if (status == 0 && save_path) {
+        if (saveDFA(&dfa, save_path)) {
+            printf("✓ Saved renumbered DFA to '%s'\n", save_path);
+        } else {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    for (size_t i = 0; i < num_strings; i++) {
+        free(strings[i]);
+    }
+    free(strings);
+    free(lengths);
+    freeProfile(&profile);
+    freeDFA(&dfa);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    // Usage: index [regex [string...]]
+    //        index --patterns <file> [string...]
+    //        index --lazy <regex> [--cache KB] [string...]
+    //        index --match <regex> [string...]
+    //        index --save <file.dfa> <regex>
+    //        index --emit-c <file.c> <regex> [function-name]
+    //        index --search <regex> [--earliest] [file]
+    //        index --lex <rules-file> [file]
+    //        index --profile <regex> <sample-file> [--save <file.dfa>]
+    if (argc == 4 && strcmp(argv[1], "--save") == 0) {
+        return runSave(argv[2], argv[3]);
+    }
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "--emit-c") == 0) {
+        return runEmitC(argv[2], argv[3], argc == 5 ? argv[4] : "dfa_match");
+    }
+    if (argc > 2 && argc <= 5 && strcmp(argv[1], "--search") == 0) {
+        bool earliest = argc > 3 && strcmp(argv[3], "--earliest") == 0;
+        int file_arg = earliest ? 4 : 3;
+        if (argc > file_arg + 1) {
+            fprintf(stderr, "Usage: %s --search <regex> [--earliest] [file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        return runSearch(argv[2], earliest ? STREAM_EARLIEST : STREAM_LEFTMOST_LONGEST,
+                         argc > file_arg ? argv[file_arg] : NULL);
+    }
+    if ((argc == 4 || argc == 6) && strcmp(argv[1], "--profile") == 0) {
+        if (argc == 6 && strcmp(argv[4], "--save") != 0) {
+            fprintf(stderr, "Usage: %s --profile <regex> <sample-file> [--save <file.dfa>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        return runProfile(argv[2], argv[3], argc == 6 ? argv[5] : NULL);
+    }
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "--lex") == 0) {
+        return runLex(argv[2], argc == 4 ? argv[3] : NULL);
+    }
+    if (argc > 2 && strcmp(argv[1], "--patterns") == 0) {
+        return runPatternSet(argv[2], argv + 3, argc - 3);
+    }
+    if (argc > 2 && strcmp(argv[1], "--match") == 0) {
+        return runMatch(argv[2], argv + 3, argc - 3);
+    }
+    if (argc > 2 && strcmp(argv[1], "--lazy") == 0) {
+        size_t cache_kb = 1024;
+        int first = 3;
+        if (argc > 4 && strcmp(argv[3], "--cache") == 0) {
+            cache_kb = (size_t)atol(argv[4]);
+            first = 5;
+        }
+        return runLazy(argv[2], cache_kb * 1024, argv + first, argc - first);
+    }
+    const char* pattern = argc > 1 ? argv[1] : "(a|b)*abb";
+
+    DFA dfa;
+    char error[256];
+    if (!compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "✗ Error: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
     // Test strings
-    const char* test_strings[] = {"abb", "aabb", "babb", "ababb", "abba", "aababb"};
-    int num_tests = sizeof(test_strings) / sizeof(test_strings[0]);
-    
+    const char* default_strings[] = {"abb", "aabb", "babb", "ababb", "abba", "aababb"};
+    const char** test_strings = default_strings;
+    int num_tests = sizeof(default_strings) / sizeof(default_strings[0]);
+    if (argc > 2) {
+        test_strings = (const char**)(argv + 2);
+        num_tests = argc - 2;
+    }
+
     printf("========================================\n");
     printf("Regular Expression to DFA Converter\n");
     printf("========================================\n");
     printf("\nInput Regular Expression: %s\n", dfa.regex);
-    printf("\nDescription: Accepts all strings ending with 'abb'\n");
-    printf("             over alphabet {a, b}\n");
-    
+
     printf("\n========================================\n");
     printf("DFA Construction\n");
     printf("========================================\n");
-    
+
+    MinimizeReport report;
+    minimizeDFA(&dfa, &report);
+    printf("\nMinimization (Hopcroft):\n");
+    printf("  States before: %d\n", report.states_before);
+    printf("  Unreachable states removed: %d\n", report.unreachable_states);
+    printf("  States after: %d\n", report.states_after);
+
     printf("\nNumber of States: %d\n", dfa.num_states);
-    printf("Alphabet: {");
-    for (int i = 0; i < dfa.num_symbols; i++) {
-        printf("%c", dfa.symbols[i]);
-        if (i < dfa.num_symbols - 1) printf(", ");
+    printf("Alphabet Size: %d (%d byte classes)\n", dfa.num_symbols, dfa.num_classes);
+    if (dfa.num_symbols <= MAX_PRINTED_SYMBOLS) {
+        printf("Alphabet: {");
+        for (int i = 0; i < dfa.num_symbols; i++) {
+            unsigned char c = (unsigned char)dfa.symbols[i];
+            // UTF-8 lead and continuation bytes are not characters on their own
+            if (c > ' ' && c < 127) {
+                printf("%c", c);
+            } else {
+                printf("0x%02X", c);
+            }
+            if (i < dfa.num_symbols - 1) printf(", ");
+        }
+        printf("}\n");
     }
-    printf("}\n");
     printf("Start State: %s\n", dfa.state_names[dfa.start_state]);
-    printf("Accepting States: {");
-    bool first = true;
-    for (int i = 0; i < dfa.num_states; i++) {
-        if (dfa.accepting_states[i]) {
-            if (!first) printf(", ");
-            printf("%s", dfa.state_names[i]);
-            first = false;
+
+    CombTable comb;
+    if (selectTableLayout(&dfa, &comb)) freeCombTable(&comb);
+    printf("\n");
+
+    bool small = dfa.num_states <= MAX_PRINTED_STATES && dfa.num_symbols <= MAX_PRINTED_SYMBOLS;
+    if (small) {
+        printf("Accepting States: {");
+        bool first = true;
+        for (int i = 0; i < dfa.num_states; i++) {
+            if (dfa.accepting_states[i]) {
+                if (!first) printf(", ");
+                printf("%s", dfa.state_names[i]);
+                first = false;
+            }
         }
+        printf("}\n");
+
+        printStateDescriptions(&dfa);
+
+        printf("========================================\n");
+        printf("Output: DFA Transition Table\n");
+        printf("========================================\n\n");
+
+        printTransitionTable(&dfa);
+    } else {
+        printf("\n(Transition table too large to display)\n\n");
     }
-    printf("}\n");
-    
-    printStateDescriptions(&dfa);
-    
-    printf("========================================\n");
-    printf("Output: DFA Transition Table\n");
-    printf("========================================\n\n");
-    
-    printTransitionTable(&dfa);
-    
+
     printf("========================================\n");
     printf("Testing Strings\n");
     printf("========================================\n");
-    
-    bool results[num_tests];
+
+    bool* results = xmalloc((size_t)num_tests * sizeof(bool));
     for (int i = 0; i < num_tests; i++) {
         const char* str = test_strings[i];
         printf("\n[Test %d] String: '%s'\n", i+1, str);
         printf("----------------------------------------\n");
         results[i] = validateString(&dfa, str);
     }
-    
+
     printf("\n========================================\n");
     printf("Summary\n");
     printf("========================================\n");
     for (int i = 0; i < num_tests; i++) {
-        printf("  '%s': %s\n", test_strings[i], 
+        printf("  '%s': %s\n", test_strings[i],
                results[i] ? "ACCEPTED ✓" : "REJECTED ✗");
     }
-    
+    free(results);
+
     // Generate DOT file
     printf("\n========================================\n");
     printf("Generating DFA Visualization\n");
@@ -289,28 +760,21 @@ int main() {
     const char* dot_filename = "dfa_diagram.dot";
     generateDotFile(&dfa, dot_filename);
     printf("DFA DOT file '%s' created.\n", dot_filename);
-    
-    // Convert DOT file to PNG using Graphviz
-    printf("Converting DOT file to PNG...\n");
-    char command[256];
-    snprintf(command, sizeof(command), "dot -Tpng %s -o dfa_output.png -Gdpi=300", dot_filename);
-    int result = system(command);
-    
-    if (result == 0) {
-        printf("✓ DFA diagram saved as 'dfa_output.png'\n");
-    } else {
-        printf("✗ Error: Could not generate PNG.\n");
-        printf("  Make sure Graphviz is installed and 'dot' is in your PATH.\n");
-        printf("  Manual conversion: dot -Tpng %s -o dfa_output.png\n", dot_filename);
-    }
-    
+
+    // Draw the diagram in process (no Graphviz needed)
+    const char* svg_filename = "dfa_diagram.svg";
+    generateSvgFile(&dfa, svg_filename);
+    printf("✓ DFA diagram saved as '%s'\n", svg_filename);
+    printf("  For a Graphviz rendering: dot -Tpng %s -o dfa_output.png\n", dot_filename);
+
     printf("\n========================================\n");
     printf("Conversion Complete!\n");
     printf("========================================\n");
     printf("\nOutput Files:\n");
     printf("  1. DFA Transition Table (displayed above)\n");
-    printf("  2. DFA Diagram: dfa_output.png\n");
+    printf("  2. DFA Diagram: %s\n", svg_filename);
     printf("  3. DOT File: %s\n", dot_filename);
-    
+
+    freeDFA(&dfa);
     return 0;
 }
@@ -0,0 +1,113 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lazy.h"
+
+// Cache a state for set (if new) and return its index
+static int cacheState(LazyDFA* lazy, const uint64_t* set) {
+    bool added;
+    int state = stateSetIntern(&lazy->cache, set, &added);
+    if (added) {
+        int k = lazy->pa.num_classes;
+        for (int j = 0; j < k; j++) {
+            lazy->table[(size_t)state * k + j] = -1;
+        }
+        lazy->accepting[state] = false;
+        for (int p = 0; p < lazy->pa.num_patterns; p++) {
+            if (positionsAccept(&lazy->pa, set, p)) lazy->accepting[state] = true;
+        }
+        if (lazy->cache.count > lazy->stats.peak_states) {
+            lazy->stats.peak_states = lazy->cache.count;
+        }
+    }
+    return state;
+}
+
+// Empty the cache, keeping only the start state
+static void flushCache(LazyDFA* lazy) {
+    stateSetMapClear(&lazy->cache);
+    lazy->stats.flushes++;
+    lazy->start_state = cacheState(lazy, lazy->pa.first);
+}
+
+// Compute the transition from state on class k (a cache miss)
+static int computeTransition(LazyDFA* lazy, int state, int k) {
+    lazy->stats.misses++;
+    uint64_t* next = lazy->scratch;
+    positionsStep(&lazy->pa, stateSetAt(&lazy->cache, state), k, next);
+
+    int target = stateSetFind(&lazy->cache, next);
+    if (target < 0) {
+        if (lazy->cache.count >= lazy->max_states) {
+            // The old state is gone after a flush, so the transition
+            // itself is not recorded
+            flushCache(lazy);
+            return cacheState(lazy, next);
+        }
+        target = cacheState(lazy, next);
+    }
+    lazy->table[(size_t)state * lazy->pa.num_classes + k] = target;
+    return target;
+}
+
+// Prepare a lazy DFA with a bounded cache
+bool compileLazy(const char* pattern, size_t cache_bytes, LazyDFA* lazy, char* err, size_t err_len) {
+    if (!buildPositions(&pattern, 1, &lazy->pa, err, err_len)) {
+        return false;
+    }
+
+    // Per state: its position set, transition row, accepting flag and
+    // up to four hash slots (the map stays at most half full)
+    int words = lazy->pa.words;
+    int k = lazy->pa.num_classes;
+    size_t state_bytes = (size_t)words * sizeof(uint64_t) + (size_t)k * sizeof(int)
+                       + sizeof(bool) + 4 * sizeof(int);
+    size_t max_states = cache_bytes / state_bytes;
+    if (max_states < 2) max_states = 2;
+    if (max_states > (size_t)INT_MAX / k) max_states = (size_t)INT_MAX / k;
+
+    lazy->max_states = (int)max_states;
+    stateSetMapInit(&lazy->cache, words);
+    lazy->table = xmalloc(max_states * k * sizeof(int));
+    lazy->accepting = xmalloc(max_states * sizeof(bool));
+    lazy->scratch = xmalloc((size_t)words * sizeof(uint64_t));
+    memset(&lazy->stats, 0, sizeof(lazy->stats));
+    lazy->start_state = cacheState(lazy, lazy->pa.first);
+    return true;
+}
+
+// Release all memory owned by the lazy DFA
+void freeLazyDFA(LazyDFA* lazy) {
+    freePositions(&lazy->pa);
+    stateSetMapFree(&lazy->cache);
+    free(lazy->table);
+    free(lazy->accepting);
+    free(lazy->scratch);
+    memset(lazy, 0, sizeof(*lazy));
+}
+
+// Silent acceptance test
+bool lazy_accepts(LazyDFA* lazy, const char* str, size_t len) {
+    const unsigned char* class_map = lazy->pa.class_map;
+    const int* table = lazy->table;
+    int num_classes = lazy->pa.num_classes;
+    size_t misses = lazy->stats.misses;
+    int state = lazy->start_state;
+
+    for (size_t i = 0; i < len; i++) {
+        int cls = class_map[(unsigned char)str[i]];
+        int next = table[state * num_classes + cls];
+        if (next < 0) {
+            next = computeTransition(lazy, state, cls);
+        }
+        state = next;
+    }
+
+    lazy->stats.hits += len - (lazy->stats.misses - misses);
+    return lazy->accepting[state];
+}
+
+// Number of states currently cached
+int lazyCachedStates(const LazyDFA* lazy) {
+    return lazy->cache.count;
+}
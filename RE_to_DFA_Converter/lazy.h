@@ -0,0 +1,47 @@
+#ifndef LAZY_H
+#define LAZY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "regex.h"
+#include "stateset.h"
+
+// Cache counters of a lazy DFA
+typedef struct {
+    size_t hits;        // transitions already in the cache
+    size_t misses;      // transitions computed from position sets
+    size_t flushes;     // times the full cache was emptied
+    int peak_states;    // most states cached at once
+} LazyStats;
+
+// On-demand DFA: states are built from the position automaton only when
+// input drives into them and are cached in a bounded table. When the
+// cache is full it is flushed and rebuilt from the current state, so
+// memory stays bounded even for patterns whose full DFA is exponential,
+// e.g. (a|b)*a(a|b){20}.
+typedef struct {
+    PositionAutomaton pa;
+    int max_states;
+    StateSetMap cache;      // position set -> cached state index
+    int* table;             // max_states rows of num_classes, -1 = not computed
+    bool* accepting;
+    int start_state;
+    uint64_t* scratch;
+    LazyStats stats;
+} LazyDFA;
+
+// Prepare a lazy DFA for pattern whose cache uses about cache_bytes
+// (at least two states are always kept). Same syntax and errors as
+// compileRegex, except that the state limit does not apply.
+bool compileLazy(const char* pattern, size_t cache_bytes, LazyDFA* lazy, char* err, size_t err_len);
+
+// Release all memory owned by the lazy DFA
+void freeLazyDFA(LazyDFA* lazy);
+
+// Silent acceptance test; builds states as needed and updates stats
+bool lazy_accepts(LazyDFA* lazy, const char* str, size_t len);
+
+// Number of states currently cached
+int lazyCachedStates(const LazyDFA* lazy);
+
+#endif
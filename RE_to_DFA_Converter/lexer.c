@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "regex.h"
+#include "minimize.h"
+
+// Compile rules into one DFA with priority-resolved accepting states
+bool compileLexer(const LexRule* rules, int num_rules, Lexer* lexer, char* err, size_t err_len) {
+    const char** patterns = xmalloc((size_t)num_rules * sizeof(char*));
+    for (int r = 0; r < num_rules; r++) {
+        patterns[r] = rules[r].pattern;
+    }
+    bool ok = compilePatternSet(patterns, num_rules, &lexer->dfa, err, err_len);
+    free(patterns);
+    if (!ok) return false;
+
+    // Keep only the earliest rule in each accept set before minimizing, so
+    // states that differ only in rules that can never win are merged
+    DFA* dfa = &lexer->dfa;
+    for (int s = 0; s < dfa->num_states; s++) {
+        if (!dfa->accepting_states[s]) continue;
+        int winner = 0;
+        while (!stateMatchesPattern(dfa, s, winner)) winner++;
+        memset(dfa->accept_sets + (size_t)s * dfa->accept_words, 0,
+               (size_t)dfa->accept_words * sizeof(uint64_t));
+        addAcceptingPattern(dfa, s, winner);
+    }
+    MinimizeReport report;
+    minimizeDFA(dfa, &report);
+
+    lexer->num_rules = num_rules;
+    lexer->state_token = xmalloc((size_t)dfa->num_states * sizeof(int));
+    for (int s = 0; s < dfa->num_states; s++) {
+        lexer->state_token[s] = LEX_ERROR;
+        for (int r = 0; r < num_rules && dfa->accepting_states[s]; r++) {
+            if (stateMatchesPattern(dfa, s, r)) {
+                lexer->state_token[s] = rules[r].token_id;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// Release all memory owned by the lexer
+void freeLexer(Lexer* lexer) {
+    freeDFA(&lexer->dfa);
+    free(lexer->state_token);
+    lexer->state_token = NULL;
+}
+
+// Tokenize with the longest-match rule. Each token restarts the DFA at
+// the start state and runs until the dead state (or the end of the
+// buffer), remembering the last accepting position; the input is then
+// rewound to just after it.
+size_t lexBuffer(const Lexer* lexer, const char* buf, size_t len, size_t* offset,
+                 Token* tokens, size_t max_tokens) {
+    const DFA* dfa = &lexer->dfa;
+    const int* table = dfa->transition_table;
+    const unsigned char* class_map = dfa->class_map;
+    const bool* accepting = dfa->accepting_states;
+    const int* state_token = lexer->state_token;
+    const unsigned char* p = (const unsigned char*)buf;
+    int k = dfa->num_classes;
+    int start = dfa->start_state;
+    int dead = dfa->dead_state;
+
+    size_t pos = *offset, count = 0;
+    while (pos < len && count < max_tokens) {
+        int state = start;
+        size_t end = pos;
+        int id = LEX_ERROR;
+        for (size_t i = pos; i < len; i++) {
+            state = table[state * k + class_map[p[i]]];
+            if (state == dead) break;
+            if (accepting[state]) {
+                end = i + 1;
+                id = state_token[state];
+            }
+        }
+        if (end == pos) {
+            end = pos + 1;
+            id = LEX_ERROR;
+        }
+        if (id != LEX_SKIP) {
+            tokens[count].offset = pos;
+            tokens[count].length = end - pos;
+            tokens[count].id = id;
+            count++;
+        }
+        pos = end;
+    }
+    *offset = pos;
+    return count;
+}
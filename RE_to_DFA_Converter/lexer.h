@@ -0,0 +1,54 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "dfa.h"
+
+// Token id for rules whose matches are consumed but not emitted
+// (whitespace, comments)
+#define LEX_SKIP (-1)
+// Token id of the one-byte token emitted where no rule matches
+#define LEX_ERROR (-2)
+
+// One lexer rule: a regular expression (compileRegex syntax) and the
+// token id reported for its matches (non-negative, or LEX_SKIP)
+typedef struct {
+    const char* pattern;
+    int token_id;
+} LexRule;
+
+// Zero-copy token: bytes [offset, offset + length) of the lexed buffer
+typedef struct {
+    size_t offset;
+    size_t length;
+    int id;
+} Token;
+
+// Maximal-munch lexer: all rules compiled into one DFA. Where several
+// rules accept the same text, the earliest rule wins; this is resolved
+// when the lexer is built, so every accepting state carries exactly one
+// rule (which also lets minimization merge more states).
+typedef struct {
+    DFA dfa;
+    int num_rules;
+    int* state_token;        // per state: token id of its winning rule
+} Lexer;
+
+// Compile rules into a lexer. On failure returns false and writes a
+// message naming the offending rule into err.
+bool compileLexer(const LexRule* rules, int num_rules, Lexer* lexer, char* err, size_t err_len);
+
+// Release all memory owned by the lexer
+void freeLexer(Lexer* lexer);
+
+// Tokenize buf from *offset on: at each position the longest non-empty
+// match of any rule becomes a token (ties go to the earlier rule). Stops
+// after max_tokens tokens or at the end of buf, advances *offset past the
+// consumed bytes and returns the number of tokens stored. LEX_SKIP matches
+// are consumed without a token. buf is treated as the complete input, so
+// the last token ends at len at the latest.
+size_t lexBuffer(const Lexer* lexer, const char* buf, size_t len, size_t* offset,
+                 Token* tokens, size_t max_tokens);
+
+#endif
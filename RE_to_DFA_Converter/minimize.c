@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <string.h>
+#include "minimize.h"
+
+// Drop unreachable states and renumber the rest in BFS order, with the
+// dead state (if reachable) numbered last. Returns the number removed.
+static int removeUnreachableStates(DFA* dfa) {
+    int n = dfa->num_states;
+    int k = dfa->num_classes;
+    int dead = findDeadState(dfa);
+    int* order = xmalloc((size_t)n * sizeof(int));
+    int* state_map = xmalloc((size_t)n * sizeof(int));
+    memset(state_map, -1, (size_t)n * sizeof(int));
+
+    int head = 0, tail = 0;
+    bool dead_reached = dead == dfa->start_state;
+    if (!dead_reached) {
+        state_map[dfa->start_state] = tail;
+        order[tail++] = dfa->start_state;
+    }
+
+    while (head < tail) {
+        int s = order[head++];
+        for (int j = 0; j < k; j++) {
+            int t = dfa->transition_table[s * k + j];
+            if (t == dead) {
+                dead_reached = true;
+            } else if (state_map[t] < 0) {
+                state_map[t] = tail;
+                order[tail++] = t;
+            }
+        }
+    }
+    if (dead_reached) {
+        state_map[dead] = tail;
+        order[tail++] = dead;
+    }
+
+    bool identity = tail == n;
+    for (int i = 0; i < tail && identity; i++) {
+        identity = order[i] == i;
+    }
+
+    int removed = n - tail;
+    if (!identity) {
+        remapStates(dfa, state_map, tail);
+    }
+    dfa->dead_state = dead_reached ? tail - 1 : -1;
+    free(order);
+    free(state_map);
+    return removed;
+}
+
+// qsort context for the initial partition
+static const DFA* sort_dfa;
+
+// Order states by accept set (the empty set, i.e. non-accepting, first)
+static int compareAcceptSets(const void* a, const void* b) {
+    int s = *(const int*)a;
+    int t = *(const int*)b;
+    const uint64_t* set_s = stateAcceptSet(sort_dfa, s);
+    const uint64_t* set_t = stateAcceptSet(sort_dfa, t);
+    for (int w = sort_dfa->accept_words - 1; w >= 0; w--) {
+        if (set_s[w] != set_t[w]) return set_s[w] < set_t[w] ? -1 : 1;
+    }
+    return s - t;
+}
+
+// Hopcroft minimization
+void minimizeDFA(DFA* dfa, MinimizeReport* report) {
+    report->states_before = dfa->num_states;
+    report->unreachable_states = removeUnreachableStates(dfa);
+    report->splits = 0;
+
+    int n = dfa->num_states;
+    int k = dfa->num_classes;
+
+    // Inverse transitions: preds[pred_start[j * n + t] ..] are the states
+    // that move to t on class j
+    int* pred_start = xcalloc((size_t)k * n + 1, sizeof(int));
+    int* preds = xmalloc((size_t)k * n * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        for (int j = 0; j < k; j++) {
+            pred_start[j * n + dfa->transition_table[s * k + j] + 1]++;
+        }
+    }
+    for (int i = 0; i < k * n; i++) {
+        pred_start[i + 1] += pred_start[i];
+    }
+    int* cursor = xmalloc((size_t)k * n * sizeof(int));
+    memcpy(cursor, pred_start, (size_t)k * n * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        for (int j = 0; j < k; j++) {
+            int slot = j * n + dfa->transition_table[s * k + j];
+            preds[cursor[slot]++] = s;
+        }
+    }
+    free(cursor);
+
+    // Partition: each block is a contiguous range of elements[]
+    int* elements = xmalloc((size_t)n * sizeof(int));
+    int* loc = xmalloc((size_t)n * sizeof(int));
+    int* block_of = xmalloc((size_t)n * sizeof(int));
+    int* block_start = xmalloc((size_t)n * sizeof(int));
+    int* block_end = xmalloc((size_t)n * sizeof(int));
+    int* marked = xcalloc(n, sizeof(int));
+    bool* in_worklist = xcalloc(n, sizeof(bool));
+    int* worklist = xmalloc((size_t)n * sizeof(int));
+    int* touched = xmalloc((size_t)n * sizeof(int));
+    int* splitter = xmalloc((size_t)n * sizeof(int));
+    int num_blocks = 0;
+    int worklist_size = 0;
+
+    // Initial partition: one block per distinct accept set, so states that
+    // report different patterns are never merged. Every block but the
+    // largest starts on the worklist.
+    for (int s = 0; s < n; s++) {
+        elements[s] = s;
+    }
+    sort_dfa = dfa;
+    qsort(elements, n, sizeof(int), compareAcceptSets);
+    size_t set_bytes = (size_t)dfa->accept_words * sizeof(uint64_t);
+    int largest = 0;
+    for (int i = 0; i < n; i++) {
+        int s = elements[i];
+        if (i == 0 || memcmp(stateAcceptSet(dfa, s), stateAcceptSet(dfa, elements[i - 1]), set_bytes) != 0) {
+            if (num_blocks > 0) block_end[num_blocks - 1] = i;
+            block_start[num_blocks++] = i;
+        }
+        loc[s] = i;
+        block_of[s] = num_blocks - 1;
+    }
+    if (num_blocks > 0) block_end[num_blocks - 1] = n;
+    for (int b = 1; b < num_blocks; b++) {
+        if (block_end[b] - block_start[b] > block_end[largest] - block_start[largest]) largest = b;
+    }
+    for (int b = 0; b < num_blocks; b++) {
+        if (b == largest) continue;
+        worklist[worklist_size++] = b;
+        in_worklist[b] = true;
+    }
+
+    while (worklist_size > 0) {
+        int a = worklist[--worklist_size];
+        in_worklist[a] = false;
+        int len = block_end[a] - block_start[a];
+        memcpy(splitter, elements + block_start[a], (size_t)len * sizeof(int));
+
+        for (int j = 0; j < k; j++) {
+            // Move every predecessor to the front of its block
+            int num_touched = 0;
+            for (int i = 0; i < len; i++) {
+                int slot = j * n + splitter[i];
+                for (int e = pred_start[slot]; e < pred_start[slot + 1]; e++) {
+                    int p = preds[e];
+                    int y = block_of[p];
+                    int first_unmarked = block_start[y] + marked[y];
+                    if (loc[p] < first_unmarked) continue;
+
+                    if (marked[y] == 0) touched[num_touched++] = y;
+                    int other = elements[first_unmarked];
+                    elements[first_unmarked] = p;
+                    elements[loc[p]] = other;
+                    loc[other] = loc[p];
+                    loc[p] = first_unmarked;
+                    marked[y]++;
+                }
+            }
+
+            // Split touched blocks; the smaller half becomes the new block
+            for (int t = 0; t < num_touched; t++) {
+                int y = touched[t];
+                int m = marked[y];
+                int size = block_end[y] - block_start[y];
+                marked[y] = 0;
+                if (m == size) continue;
+
+                int z = num_blocks++;
+                if (m <= size - m) {
+                    block_start[z] = block_start[y];
+                    block_end[z] = block_start[y] + m;
+                    block_start[y] += m;
+                } else {
+                    block_start[z] = block_start[y] + m;
+                    block_end[z] = block_end[y];
+                    block_end[y] = block_start[y] + m;
+                }
+                for (int e = block_start[z]; e < block_end[z]; e++) {
+                    block_of[elements[e]] = z;
+                }
+
+                // If y is still pending both halves will be processed;
+                // otherwise processing the smaller half is sufficient
+                worklist[worklist_size++] = z;
+                in_worklist[z] = true;
+                report->splits++;
+            }
+        }
+    }
+
+    if (num_blocks < n) {
+        remapStates(dfa, block_of, num_blocks);
+        removeUnreachableStates(dfa);
+    }
+    report->states_after = dfa->num_states;
+
+    free(pred_start);
+    free(preds);
+    free(elements);
+    free(loc);
+    free(block_of);
+    free(block_start);
+    free(block_end);
+    free(marked);
+    free(in_worklist);
+    free(worklist);
+    free(touched);
+    free(splitter);
+}
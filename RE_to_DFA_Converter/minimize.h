@@ -0,0 +1,19 @@
+#ifndef MINIMIZE_H
+#define MINIMIZE_H
+
+#include "dfa.h"
+
+// Statistics reported by minimizeDFA
+typedef struct {
+    int states_before;
+    int unreachable_states;
+    int states_after;
+    int splits;
+} MinimizeReport;
+
+// Remove unreachable states and merge equivalent ones (Hopcroft's
+// partition refinement, O(n k log n)). States are renumbered in
+// breadth-first order from the start state, so the start state is q0.
+void minimizeDFA(DFA* dfa, MinimizeReport* report);
+
+#endif
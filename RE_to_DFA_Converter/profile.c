@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+// Create an all-zero profile for dfa
+void initProfile(DFAProfile* profile, const DFA* dfa) {
+    profile->num_states = dfa->num_states;
+    profile->num_classes = dfa->num_classes;
+    profile->hits = xcalloc((size_t)dfa->num_states * dfa->num_classes, sizeof(uint64_t));
+    profile->bytes = 0;
+}
+
+// Release all memory owned by the profile
+void freeProfile(DFAProfile* profile) {
+    free(profile->hits);
+    profile->hits = NULL;
+}
+
+// State reached after len bytes, counting each transition taken
+int dfa_run_profiled(const DFA* dfa, const char* str, size_t len, DFAProfile* profile) {
+    const unsigned char* class_map = dfa->class_map;
+    const int* table = dfa->transition_table;
+    uint64_t* hits = profile->hits;
+    int num_classes = dfa->num_classes;
+    int state = dfa->start_state;
+    for (size_t i = 0; i < len; i++) {
+        size_t slot = (size_t)state * num_classes + class_map[(unsigned char)str[i]];
+        hits[slot]++;
+        state = table[slot];
+    }
+    profile->bytes += len;
+    return state;
+}
+
+// Order states by profile: chains of hottest successors
+void profileStateOrder(const DFA* dfa, const DFAProfile* profile, int* state_map) {
+    int n = dfa->num_states, k = dfa->num_classes;
+    uint64_t* visits = xcalloc((size_t)n, sizeof(uint64_t));
+    uint64_t* weight = xcalloc((size_t)n, sizeof(uint64_t));
+    int* by_visits = xmalloc((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        state_map[s] = -1;
+        for (int j = 0; j < k; j++) visits[s] += profile->hits[(size_t)s * k + j];
+    }
+
+    // Chain starts: visited states, hottest first (insertion sort keeps
+    // ties in the old order; the profile's hot set is usually small)
+    int num_visited = 0;
+    for (int s = 0; s < n; s++) {
+        if (visits[s] == 0 || s == dfa->dead_state) continue;
+        int i = num_visited++;
+        while (i > 0 && visits[by_visits[i - 1]] < visits[s]) {
+            by_visits[i] = by_visits[i - 1];
+            i--;
+        }
+        by_visits[i] = s;
+    }
+
+    int next_number = 0, next_start = 0;
+    int current = dfa->start_state != dfa->dead_state ? dfa->start_state : -1;
+    while (current >= 0) {
+        state_map[current] = next_number++;
+
+        // Hottest unplaced successor of current
+        int best = -1;
+        for (int j = 0; j < k; j++) {
+            int t = dfa->transition_table[(size_t)current * k + j];
+            weight[t] += profile->hits[(size_t)current * k + j];
+        }
+        for (int j = 0; j < k; j++) {
+            int t = dfa->transition_table[(size_t)current * k + j];
+            if (state_map[t] < 0 && t != dfa->dead_state && weight[t] > 0 &&
+                (best < 0 || weight[t] > weight[best])) {
+                best = t;
+            }
+        }
+        for (int j = 0; j < k; j++) {
+            weight[dfa->transition_table[(size_t)current * k + j]] = 0;
+        }
+
+        if (best < 0) {
+            while (next_start < num_visited && state_map[by_visits[next_start]] >= 0) next_start++;
+            best = next_start < num_visited ? by_visits[next_start] : -1;
+        }
+        current = best;
+    }
+
+    for (int s = 0; s < n; s++) {
+        if (state_map[s] < 0 && s != dfa->dead_state) state_map[s] = next_number++;
+    }
+    if (dfa->dead_state >= 0) state_map[dfa->dead_state] = next_number++;
+
+    free(visits);
+    free(weight);
+    free(by_visits);
+}
+
+// Renumber states by profile
+void renumberByProfile(DFA* dfa, const DFAProfile* profile) {
+    int* state_map = xmalloc((size_t)dfa->num_states * sizeof(int));
+    profileStateOrder(dfa, profile, state_map);
+    remapStates(dfa, state_map, dfa->num_states);
+    free(state_map);
+}
+
+// Replay table reads through the simulated cache
+void simulateTableCache(const DFA* dfa, const char* const* strings, const size_t* lengths,
+                        size_t num_strings, CacheSimResult* result) {
+    enum { SETS = SIM_CACHE_BYTES / (SIM_CACHE_WAYS * SIM_CACHE_LINE) };
+    size_t* tags = xmalloc((size_t)SETS * SIM_CACHE_WAYS * sizeof(size_t));
+    uint64_t* last_use = xcalloc((size_t)SETS * SIM_CACHE_WAYS, sizeof(uint64_t));
+    size_t table_lines = ((size_t)dfa->num_states * dfa->num_classes * sizeof(int)) / SIM_CACHE_LINE + 1;
+    bool* touched = xcalloc(table_lines, sizeof(bool));
+    for (size_t w = 0; w < (size_t)SETS * SIM_CACHE_WAYS; w++) tags[w] = (size_t)-1;
+
+    const unsigned char* class_map = dfa->class_map;
+    const int* table = dfa->transition_table;
+    int num_classes = dfa->num_classes;
+    uint64_t clock = 0, misses = 0, lines_touched = 0;
+    for (size_t s = 0; s < num_strings; s++) {
+        int state = dfa->start_state;
+        for (size_t i = 0; i < lengths[s]; i++) {
+            size_t slot = (size_t)state * num_classes + class_map[(unsigned char)strings[s][i]];
+            size_t line = slot * sizeof(int) / SIM_CACHE_LINE;
+            if (!touched[line]) {
+                touched[line] = true;
+                lines_touched++;
+            }
+
+            // LRU lookup in the line's set
+            size_t* set_tags = tags + (line % SETS) * SIM_CACHE_WAYS;
+            uint64_t* set_use = last_use + (line % SETS) * SIM_CACHE_WAYS;
+            int way = 0, victim = 0;
+            while (way < SIM_CACHE_WAYS && set_tags[way] != line) {
+                if (set_use[way] < set_use[victim]) victim = way;
+                way++;
+            }
+            if (way == SIM_CACHE_WAYS) {
+                misses++;
+                way = victim;
+                set_tags[way] = line;
+            }
+            set_use[way] = ++clock;
+            state = table[slot];
+        }
+    }
+
+    result->accesses = clock;
+    result->misses = misses;
+    result->lines_touched = lines_touched;
+    free(tags);
+    free(last_use);
+    free(touched);
+}
@@ -0,0 +1,56 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dfa.h"
+
+// Transition hit counts of a DFA, collected by running it over sample
+// input with dfa_run_profiled. hits is laid out like the transition table.
+typedef struct {
+    int num_states;
+    int num_classes;
+    uint64_t* hits;          // per (state, class): transitions taken
+    uint64_t bytes;          // total transitions counted
+} DFAProfile;
+
+// Table accesses replayed through a simulated set-associative LRU cache
+typedef struct {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t lines_touched;  // distinct table cache lines used
+} CacheSimResult;
+
+// Simulated cache used by simulateTableCache: 32 KB, 8-way, 64-byte
+// lines (a typical L1 data cache)
+#define SIM_CACHE_BYTES (32 * 1024)
+#define SIM_CACHE_WAYS 8
+#define SIM_CACHE_LINE 64
+
+// Create an all-zero profile for dfa
+void initProfile(DFAProfile* profile, const DFA* dfa);
+
+// Release all memory owned by the profile
+void freeProfile(DFAProfile* profile);
+
+// dfa_run with instrumentation: counts every transition taken. Kept
+// apart from dfa_run so the uninstrumented loop pays nothing for it.
+int dfa_run_profiled(const DFA* dfa, const char* str, size_t len, DFAProfile* profile);
+
+// Order states for locality: following the hottest transitions from the
+// start state, each state is placed right after the state that enters it
+// most often; when a chain ends, the hottest unplaced state starts the
+// next. Unvisited states follow in their old order, the dead state last.
+// Fills state_map (old -> new number) for remapStates.
+void profileStateOrder(const DFA* dfa, const DFAProfile* profile, int* state_map);
+
+// Renumber dfa's states with profileStateOrder (the profile is not
+// renumbered and should be discarded afterwards)
+void renumberByProfile(DFA* dfa, const DFAProfile* profile);
+
+// Replay the table reads of dfa_run over each of the strings through the
+// simulated cache (the cache stays warm from one string to the next)
+void simulateTableCache(const DFA* dfa, const char* const* strings, const size_t* lengths,
+                        size_t num_strings, CacheSimResult* result);
+
+#endif
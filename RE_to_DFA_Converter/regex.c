@@ -0,0 +1,1028 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "regex.h"
+#include "stateset.h"
+
+// Limits that keep the followpos matrix and {n,m} expansion bounded
+#define MAX_POSITIONS 16384
+#define MAX_REPEAT 1000
+
+// ---------------------------------------------------------------------------
+// Character sets (one bit per byte value)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    uint64_t bits[4];
+} CharSet;
+
+static void charsetAdd(CharSet* set, unsigned char c) {
+    set->bits[c >> 6] |= 1ULL << (c & 63);
+}
+
+static bool charsetHas(const CharSet* set, unsigned char c) {
+    return (set->bits[c >> 6] >> (c & 63)) & 1;
+}
+
+static void charsetAddRange(CharSet* set, int lo, int hi) {
+    for (int c = lo; c <= hi; c++) {
+        charsetAdd(set, (unsigned char)c);
+    }
+}
+
+static void charsetUnion(CharSet* dst, const CharSet* src) {
+    for (int i = 0; i < 4; i++) {
+        dst->bits[i] |= src->bits[i];
+    }
+}
+
+static void charsetInvert(CharSet* set) {
+    for (int i = 0; i < 4; i++) {
+        set->bits[i] = ~set->bits[i];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Syntax tree
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    NODE_EMPTY,     // matches the empty string
+    NODE_LEAF,      // one position: any byte in chars
+    NODE_CAT,
+    NODE_ALT,
+    NODE_STAR,
+    NODE_PLUS,
+    NODE_QUEST
+} NodeKind;
+
+typedef struct Node {
+    NodeKind kind;
+    struct Node* left;
+    struct Node* right;
+    CharSet chars;
+    int pos;
+    bool nullable;
+    uint64_t* firstpos;
+    uint64_t* lastpos;
+} Node;
+
+static Node* newNode(NodeKind kind, Node* left, Node* right) {
+    Node* node = xcalloc(1, sizeof(Node));
+    node->kind = kind;
+    node->left = left;
+    node->right = right;
+    node->pos = -1;
+    return node;
+}
+
+static Node* newLeaf(const CharSet* chars) {
+    Node* node = newNode(NODE_LEAF, NULL, NULL);
+    node->chars = *chars;
+    return node;
+}
+
+static void freeTree(Node* node) {
+    if (!node) return;
+    freeTree(node->left);
+    freeTree(node->right);
+    free(node->firstpos);
+    free(node->lastpos);
+    free(node);
+}
+
+static Node* cloneTree(const Node* node) {
+    if (!node) return NULL;
+    Node* copy = newNode(node->kind, cloneTree(node->left), cloneTree(node->right));
+    copy->chars = node->chars;
+    return copy;
+}
+
+static int countLeaves(const Node* node) {
+    if (!node) return 0;
+    if (node->kind == NODE_LEAF) return 1;
+    return countLeaves(node->left) + countLeaves(node->right);
+}
+
+static Node* concat(Node* left, Node* right) {
+    if (!left) return right;
+    if (!right) return left;
+    return newNode(NODE_CAT, left, right);
+}
+
+static Node* alternate(Node* left, Node* right) {
+    if (!left) return right;
+    if (!right) return left;
+    return newNode(NODE_ALT, left, right);
+}
+
+// ---------------------------------------------------------------------------
+// Unicode classes as UTF-8 byte sequences
+//
+// A class of code points is compiled into an alternation of byte-range
+// chains, e.g. U+0391-U+03C9 becomes [\xCE][\x91-\xBF] | [\xCF][\x80-\x89],
+// so the DFA still reads one byte per step and never decodes code points.
+// ---------------------------------------------------------------------------
+
+#define MAX_CODE_POINT 0x10FFFF
+#define SURROGATE_FIRST 0xD800
+#define SURROGATE_LAST 0xDFFF
+
+typedef struct {
+    int lo;
+    int hi;
+} CodeRange;
+
+// Code point ranges, sorted and disjoint after rangeListNormalize
+typedef struct {
+    CodeRange* ranges;
+    int count;
+    int capacity;
+} RangeList;
+
+static void rangeListAdd(RangeList* list, int lo, int hi) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->ranges = xrealloc(list->ranges, (size_t)list->capacity * sizeof(CodeRange));
+    }
+    list->ranges[list->count].lo = lo;
+    list->ranges[list->count].hi = hi;
+    list->count++;
+}
+
+static int compareRanges(const void* a, const void* b) {
+    const CodeRange* x = a;
+    const CodeRange* y = b;
+    return x->lo != y->lo ? (x->lo < y->lo ? -1 : 1) : (x->hi < y->hi ? -1 : x->hi > y->hi);
+}
+
+// Sort, merge overlapping and adjacent ranges, and drop the surrogates
+// (they have no UTF-8 encoding)
+static void rangeListNormalize(RangeList* list) {
+    qsort(list->ranges, (size_t)list->count, sizeof(CodeRange), compareRanges);
+    int merged = 0;
+    for (int i = 0; i < list->count; i++) {
+        CodeRange r = list->ranges[i];
+        if (merged > 0 && r.lo <= list->ranges[merged - 1].hi + 1) {
+            if (r.hi > list->ranges[merged - 1].hi) list->ranges[merged - 1].hi = r.hi;
+        } else {
+            list->ranges[merged++] = r;
+        }
+    }
+    list->count = merged;
+
+    for (int i = 0; i < list->count; i++) {
+        CodeRange r = list->ranges[i];
+        if (r.hi < SURROGATE_FIRST || r.lo > SURROGATE_LAST) continue;
+        if (r.lo < SURROGATE_FIRST && r.hi > SURROGATE_LAST) {
+            list->ranges[i].hi = SURROGATE_FIRST - 1;
+            rangeListAdd(list, SURROGATE_LAST + 1, r.hi);
+            rangeListNormalize(list);
+            return;
+        }
+        if (r.lo < SURROGATE_FIRST) {
+            list->ranges[i].hi = SURROGATE_FIRST - 1;
+        } else if (r.hi > SURROGATE_LAST) {
+            list->ranges[i].lo = SURROGATE_LAST + 1;
+        } else {
+            memmove(list->ranges + i, list->ranges + i + 1, (size_t)(list->count - i - 1) * sizeof(CodeRange));
+            list->count--;
+            i--;
+        }
+    }
+}
+
+// Complement a normalized list within U+0000-U+10FFFF
+static void rangeListInvert(RangeList* list) {
+    RangeList inverse = { NULL, 0, 0 };
+    int next = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (list->ranges[i].lo > next) rangeListAdd(&inverse, next, list->ranges[i].lo - 1);
+        next = list->ranges[i].hi + 1;
+    }
+    if (next <= MAX_CODE_POINT) rangeListAdd(&inverse, next, MAX_CODE_POINT);
+    free(list->ranges);
+    *list = inverse;
+    rangeListNormalize(list);
+}
+
+static int utf8Encode(int cp, unsigned char out[4]) {
+    if (cp < 0x80) {
+        out[0] = (unsigned char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (unsigned char)(0xC0 | (cp >> 6));
+        out[1] = (unsigned char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (unsigned char)(0xE0 | (cp >> 12));
+        out[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (unsigned char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (unsigned char)(0xF0 | (cp >> 18));
+    out[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (unsigned char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Byte-range chains for the code points lo..hi (no surrogates). The range
+// is split until lo and hi encode to the same length and every byte after
+// the first differing one spans the full continuation range 80-BF; then
+// byte i of the chain is simply [lo_i-hi_i].
+static Node* utf8RangeNode(int lo, int hi) {
+    static const int last_of_length[] = { 0x7F, 0x7FF, 0xFFFF };
+    for (int i = 0; i < 3; i++) {
+        int boundary = last_of_length[i];
+        if (lo <= boundary && hi > boundary) {
+            return alternate(utf8RangeNode(lo, boundary), utf8RangeNode(boundary + 1, hi));
+        }
+    }
+    for (int i = 1; i < 4; i++) {
+        int mask = (1 << (6 * i)) - 1;
+        if ((lo & ~mask) == (hi & ~mask)) continue;
+        if ((lo & mask) != 0) {
+            return alternate(utf8RangeNode(lo, lo | mask), utf8RangeNode((lo | mask) + 1, hi));
+        }
+        if ((hi & mask) != mask) {
+            return alternate(utf8RangeNode(lo, (hi & ~mask) - 1), utf8RangeNode(hi & ~mask, hi));
+        }
+    }
+
+    unsigned char lo_bytes[4], hi_bytes[4];
+    int len = utf8Encode(lo, lo_bytes);
+    utf8Encode(hi, hi_bytes);
+    Node* chain = NULL;
+    for (int i = 0; i < len; i++) {
+        CharSet set = {{0}};
+        charsetAddRange(&set, lo_bytes[i], hi_bytes[i]);
+        chain = concat(chain, newLeaf(&set));
+    }
+    return chain;
+}
+
+// Alternation matching the UTF-8 encoding of any code point in a
+// normalized list; the ASCII part shares a single leaf
+static Node* rangeListNode(const RangeList* list) {
+    CharSet ascii = {{0}};
+    Node* node = NULL;
+    for (int i = 0; i < list->count; i++) {
+        int lo = list->ranges[i].lo, hi = list->ranges[i].hi;
+        if (lo < 0x80) charsetAddRange(&ascii, lo, hi < 0x80 ? hi : 0x7F);
+        if (hi >= 0x80) node = alternate(node, utf8RangeNode(lo < 0x80 ? 0x80 : lo, hi));
+    }
+    CharSet none = {{0}};
+    if (memcmp(&ascii, &none, sizeof(CharSet)) != 0 || !node) {
+        node = alternate(newLeaf(&ascii), node);
+    }
+    return node;
+}
+
+// ---------------------------------------------------------------------------
+// Recursive descent parser
+//
+//   alt    := cat ('|' cat)*
+//   cat    := repeat*
+//   repeat := atom ('*' | '+' | '?' | '{' n [',' [m]] '}')*
+//   atom   := '(' alt ')' | '[' class ']' | '.' | '\' escape | literal
+//
+// Non-ASCII literals are read as UTF-8 and, like \u escapes, become the
+// byte sequence of their encoding.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const char* pattern;
+    const char* p;
+    char* err;
+    size_t err_len;
+    bool failed;
+} Parser;
+
+static void parseError(Parser* ps, const char* fmt, ...) {
+    if (ps->failed) return;
+    ps->failed = true;
+    if (!ps->err || ps->err_len == 0) return;
+
+    int n = snprintf(ps->err, ps->err_len, "Syntax error at position %d: ",
+                     (int)(ps->p - ps->pattern));
+    if (n >= 0 && (size_t)n < ps->err_len) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(ps->err + n, ps->err_len - n, fmt, args);
+        va_end(args);
+    }
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decode the UTF-8 character at ps->p into a code point
+static int parseUtf8(Parser* ps) {
+    const unsigned char* s = (const unsigned char*)ps->p;
+    int len = s[0] >= 0xF0 ? 4 : s[0] >= 0xE0 ? 3 : s[0] >= 0xC0 ? 2 : 0;
+    int cp = len == 4 ? s[0] & 0x07 : len == 3 ? s[0] & 0x0F : s[0] & 0x1F;
+    for (int i = 1; i < len && cp >= 0; i++) {
+        cp = (s[i] & 0xC0) == 0x80 ? (cp << 6) | (s[i] & 0x3F) : -1;
+    }
+    static const int min_of_length[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (len == 0 || s[0] > 0xF4 || cp < min_of_length[len] || cp > MAX_CODE_POINT ||
+        (cp >= SURROGATE_FIRST && cp <= SURROGATE_LAST)) {
+        parseError(ps, "invalid UTF-8 in pattern (use \\xHH for raw bytes)");
+        return -1;
+    }
+    ps->p += len;
+    return cp;
+}
+
+// Parse the hex digits of \uHHHH or \u{H...}
+static int parseCodePoint(Parser* ps) {
+    bool braced = *ps->p == '{';
+    if (braced) ps->p++;
+    int cp = 0, digits = 0;
+    while (hexValue(*ps->p) >= 0 && digits < (braced ? 6 : 4)) {
+        cp = cp * 16 + hexValue(*ps->p++);
+        digits++;
+    }
+    if (braced ? digits == 0 || *ps->p++ != '}' : digits < 4) {
+        parseError(ps, "\\u needs four hex digits or \\u{...}");
+        return -1;
+    }
+    if (cp > MAX_CODE_POINT || (cp >= SURROGATE_FIRST && cp <= SURROGATE_LAST)) {
+        parseError(ps, "\\u{%X} is not a Unicode scalar value", cp);
+        return -1;
+    }
+    return cp;
+}
+
+// Parse the escape after a backslash into set.
+// Returns the byte value for single-character escapes, -1 for classes.
+// Code points from \u at or above 0x80 are returned with *wide set and are
+// not added to set (they are more than one byte).
+static int parseEscape(Parser* ps, CharSet* set, bool* wide) {
+    *wide = false;
+    char c = *ps->p;
+    if (c == '\0') {
+        parseError(ps, "trailing backslash");
+        return -1;
+    }
+    ps->p++;
+
+    int single = -1;
+    switch (c) {
+        case 'n': single = '\n'; break;
+        case 't': single = '\t'; break;
+        case 'r': single = '\r'; break;
+        case 'f': single = '\f'; break;
+        case 'v': single = '\v'; break;
+        case 'x': {
+            int hi = hexValue(ps->p[0]);
+            int lo = hi >= 0 ? hexValue(ps->p[1]) : -1;
+            if (lo < 0) {
+                parseError(ps, "\\x needs two hex digits");
+                return -1;
+            }
+            ps->p += 2;
+            single = hi * 16 + lo;
+            break;
+        }
+        case 'u':
+            single = parseCodePoint(ps);
+            if (single < 0) return -1;
+            if (single >= 0x80) {
+                *wide = true;
+                return single;
+            }
+            break;
+        case 'd':
+        case 'D':
+            charsetAddRange(set, '0', '9');
+            if (c == 'D') charsetInvert(set);
+            return -1;
+        case 'w':
+        case 'W':
+            charsetAddRange(set, 'a', 'z');
+            charsetAddRange(set, 'A', 'Z');
+            charsetAddRange(set, '0', '9');
+            charsetAdd(set, '_');
+            if (c == 'W') charsetInvert(set);
+            return -1;
+        case 's':
+        case 'S':
+            charsetAdd(set, ' ');
+            charsetAddRange(set, '\t', '\r');
+            if (c == 'S') charsetInvert(set);
+            return -1;
+        default:
+            single = (unsigned char)c;
+            break;
+    }
+
+    charsetAdd(set, (unsigned char)single);
+    return single;
+}
+
+// Parse one class member; returns its byte value, -1 for an escape class,
+// or a code point of 0x80 and above (UTF-8 or \u) with *wide set
+static int parseClassChar(Parser* ps, CharSet* set, bool* wide) {
+    if (*ps->p == '\\') {
+        ps->p++;
+        return parseEscape(ps, set, wide);
+    }
+    if ((unsigned char)*ps->p >= 0x80) {
+        *wide = true;
+        return parseUtf8(ps);
+    }
+    *wide = false;
+    unsigned char c = (unsigned char)*ps->p++;
+    charsetAdd(set, c);
+    return c;
+}
+
+// Parse a bracket expression; ps->p points just past '['. A class naming
+// a non-ASCII character is a class of code points and matches the UTF-8
+// encoding of one of them; any other class matches a single byte.
+static Node* parseClass(Parser* ps) {
+    CharSet set = {{0}};
+    RangeList wide_ranges = { NULL, 0, 0 };
+    bool negate = false;
+    bool high_bytes = false;       // \xHH above 7F: bytes, not code points
+    bool negated_escape = false;   // \D \W \S: also every non-ASCII character
+
+    if (*ps->p == '^') {
+        negate = true;
+        ps->p++;
+    }
+
+    bool first = true;
+    while (*ps->p && (*ps->p != ']' || first)) {
+        first = false;
+        CharSet item = {{0}};
+        bool lo_wide, hi_wide;
+        int lo = parseClassChar(ps, &item, &lo_wide);
+        if (ps->failed) break;
+
+        if (ps->p[0] == '-' && ps->p[1] != ']' && ps->p[1] != '\0') {
+            ps->p++;
+            CharSet upper = {{0}};
+            int hi = parseClassChar(ps, &upper, &hi_wide);
+            if (ps->failed) break;
+            if (lo < 0 || hi < 0 || hi < lo) {
+                parseError(ps, "invalid range in character class");
+                break;
+            }
+            if (hi_wide) {
+                rangeListAdd(&wide_ranges, lo, hi);
+                if (!lo_wide && lo >= 0x80) high_bytes = true;
+            } else {
+                charsetAddRange(&set, lo, hi);
+                if (hi >= 0x80) high_bytes = true;
+            }
+        } else if (lo_wide) {
+            rangeListAdd(&wide_ranges, lo, lo);
+        } else {
+            if (lo < 0 && charsetHas(&item, 0x80)) negated_escape = true;
+            if (lo >= 0x80) high_bytes = true;
+            charsetUnion(&set, &item);
+        }
+    }
+
+    if (!ps->failed && *ps->p != ']') {
+        parseError(ps, "missing ']'");
+    }
+    if (!ps->failed && wide_ranges.count > 0 && high_bytes) {
+        parseError(ps, "\\x80-\\xFF cannot be mixed with non-ASCII characters in a class (use \\u{...})");
+    }
+    if (ps->failed) {
+        free(wide_ranges.ranges);
+        return NULL;
+    }
+    ps->p++;
+
+    if (wide_ranges.count == 0) {
+        if (negate) charsetInvert(&set);
+        return newLeaf(&set);
+    }
+
+    for (int b = 0; b < 0x80; b++) {
+        if (charsetHas(&set, (unsigned char)b)) rangeListAdd(&wide_ranges, b, b);
+    }
+    if (negated_escape) rangeListAdd(&wide_ranges, 0x80, MAX_CODE_POINT);
+    rangeListNormalize(&wide_ranges);
+    if (negate) rangeListInvert(&wide_ranges);
+    Node* node = rangeListNode(&wide_ranges);
+    free(wide_ranges.ranges);
+    return node;
+}
+
+static Node* parseAlt(Parser* ps);
+
+static Node* parseAtom(Parser* ps) {
+    char c = *ps->p;
+    CharSet set = {{0}};
+
+    switch (c) {
+        case '(': {
+            ps->p++;
+            Node* node = parseAlt(ps);
+            if (*ps->p != ')') {
+                parseError(ps, "missing ')'");
+                return node;
+            }
+            ps->p++;
+            return node;
+        }
+        case '[':
+            ps->p++;
+            return parseClass(ps);
+        case '.':
+            ps->p++;
+            charsetAdd(&set, '\n');
+            charsetInvert(&set);
+            return newLeaf(&set);
+        case '\\': {
+            ps->p++;
+            bool wide;
+            int value = parseEscape(ps, &set, &wide);
+            if (ps->failed) return NULL;
+            return wide ? utf8RangeNode(value, value) : newLeaf(&set);
+        }
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            parseError(ps, "nothing to repeat before '%c'", c);
+            return NULL;
+        default:
+            if ((unsigned char)c >= 0x80) {
+                // One UTF-8 character is one atom: é* repeats both bytes
+                int cp = parseUtf8(ps);
+                return ps->failed ? NULL : utf8RangeNode(cp, cp);
+            }
+            ps->p++;
+            charsetAdd(&set, (unsigned char)c);
+            return newLeaf(&set);
+    }
+}
+
+static int parseCount(Parser* ps) {
+    if (*ps->p < '0' || *ps->p > '9') return -1;
+    int value = 0;
+    while (*ps->p >= '0' && *ps->p <= '9') {
+        if (value <= MAX_REPEAT) value = value * 10 + (*ps->p - '0');
+        ps->p++;
+    }
+    return value;
+}
+
+// Expand x{min,max} (max < 0 means unbounded) into copies of x
+static Node* expandRepeat(Parser* ps, Node* node, int min, int max) {
+    long copies = max < 0 ? min + 1 : max;
+    if ((long)countLeaves(node) * copies > MAX_POSITIONS) {
+        parseError(ps, "repetition expands beyond %d positions", MAX_POSITIONS);
+        return node;
+    }
+
+    Node* result = NULL;
+    for (int i = 0; i < min; i++) {
+        result = concat(result, cloneTree(node));
+    }
+
+    if (max < 0) {
+        result = concat(result, newNode(NODE_STAR, cloneTree(node), NULL));
+    } else {
+        // x{0,k} = (x(x(...)?)?)? keeps the optional tail linear in k
+        Node* tail = NULL;
+        for (int i = min; i < max; i++) {
+            Node* copy = cloneTree(node);
+            tail = newNode(NODE_QUEST, tail ? newNode(NODE_CAT, copy, tail) : copy, NULL);
+        }
+        result = concat(result, tail);
+    }
+
+    freeTree(node);
+    return result ? result : newNode(NODE_EMPTY, NULL, NULL);
+}
+
+static Node* parseRepeat(Parser* ps) {
+    Node* node = parseAtom(ps);
+
+    while (!ps->failed) {
+        char c = *ps->p;
+        if (c == '*') {
+            ps->p++;
+            node = newNode(NODE_STAR, node, NULL);
+        } else if (c == '+') {
+            ps->p++;
+            node = newNode(NODE_PLUS, node, NULL);
+        } else if (c == '?') {
+            ps->p++;
+            node = newNode(NODE_QUEST, node, NULL);
+        } else if (c == '{') {
+            ps->p++;
+            int min = parseCount(ps);
+            int max = min;
+            if (min < 0) {
+                parseError(ps, "expected a number after '{'");
+                break;
+            }
+            if (*ps->p == ',') {
+                ps->p++;
+                max = parseCount(ps);
+            }
+            if (*ps->p != '}') {
+                parseError(ps, "missing '}'");
+                break;
+            }
+            ps->p++;
+            if (min > MAX_REPEAT || max > MAX_REPEAT) {
+                parseError(ps, "repeat count exceeds %d", MAX_REPEAT);
+                break;
+            }
+            if (max >= 0 && max < min) {
+                parseError(ps, "repeat range {%d,%d} is inverted", min, max);
+                break;
+            }
+            node = expandRepeat(ps, node, min, max);
+        } else {
+            break;
+        }
+    }
+    return node;
+}
+
+static Node* parseCat(Parser* ps) {
+    Node* node = NULL;
+    while (!ps->failed && *ps->p && *ps->p != '|' && *ps->p != ')') {
+        node = concat(node, parseRepeat(ps));
+    }
+    return node ? node : newNode(NODE_EMPTY, NULL, NULL);
+}
+
+static Node* parseAlt(Parser* ps) {
+    Node* node = parseCat(ps);
+    while (!ps->failed && *ps->p == '|') {
+        ps->p++;
+        node = newNode(NODE_ALT, node, parseCat(ps));
+    }
+    return node;
+}
+
+// ---------------------------------------------------------------------------
+// nullable / firstpos / lastpos / followpos
+// ---------------------------------------------------------------------------
+
+static void collectLeaves(Node* node, Node** leaves, int* count) {
+    if (!node) return;
+    if (node->kind == NODE_LEAF) {
+        node->pos = *count;
+        leaves[(*count)++] = node;
+        return;
+    }
+    collectLeaves(node->left, leaves, count);
+    collectLeaves(node->right, leaves, count);
+}
+
+static void unionInto(uint64_t* dst, const uint64_t* src, int words) {
+    for (int w = 0; w < words; w++) {
+        dst[w] |= src[w];
+    }
+}
+
+// followpos(i) |= to, for every position i in from
+static void addFollow(uint64_t* followpos, const uint64_t* from, const uint64_t* to, int words) {
+    for (int w = 0; w < words; w++) {
+        uint64_t bits = from[w];
+        while (bits) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            unionInto(followpos + (size_t)i * words, to, words);
+        }
+    }
+}
+
+static void releaseSets(Node* node) {
+    if (!node) return;
+    free(node->firstpos);
+    free(node->lastpos);
+    node->firstpos = NULL;
+    node->lastpos = NULL;
+}
+
+// Post-order computation; children's sets are released once the parent has them
+static void computePositions(Node* node, uint64_t* followpos, int words) {
+    Node* l = node->left;
+    Node* r = node->right;
+    if (l) computePositions(l, followpos, words);
+    if (r) computePositions(r, followpos, words);
+
+    node->firstpos = xcalloc(words, sizeof(uint64_t));
+    node->lastpos = xcalloc(words, sizeof(uint64_t));
+
+    switch (node->kind) {
+        case NODE_EMPTY:
+            node->nullable = true;
+            break;
+        case NODE_LEAF:
+            node->nullable = false;
+            node->firstpos[node->pos / 64] |= 1ULL << (node->pos % 64);
+            node->lastpos[node->pos / 64] |= 1ULL << (node->pos % 64);
+            break;
+        case NODE_ALT:
+            node->nullable = l->nullable || r->nullable;
+            unionInto(node->firstpos, l->firstpos, words);
+            unionInto(node->firstpos, r->firstpos, words);
+            unionInto(node->lastpos, l->lastpos, words);
+            unionInto(node->lastpos, r->lastpos, words);
+            break;
+        case NODE_CAT:
+            node->nullable = l->nullable && r->nullable;
+            unionInto(node->firstpos, l->firstpos, words);
+            if (l->nullable) unionInto(node->firstpos, r->firstpos, words);
+            unionInto(node->lastpos, r->lastpos, words);
+            if (r->nullable) unionInto(node->lastpos, l->lastpos, words);
+            addFollow(followpos, l->lastpos, r->firstpos, words);
+            break;
+        case NODE_STAR:
+        case NODE_PLUS:
+        case NODE_QUEST:
+            node->nullable = node->kind == NODE_PLUS ? l->nullable : true;
+            unionInto(node->firstpos, l->firstpos, words);
+            unionInto(node->lastpos, l->lastpos, words);
+            if (node->kind != NODE_QUEST) {
+                addFollow(followpos, l->lastpos, l->firstpos, words);
+            }
+            break;
+    }
+
+    releaseSets(l);
+    releaseSets(r);
+}
+
+// ---------------------------------------------------------------------------
+// Position automaton
+// ---------------------------------------------------------------------------
+
+static bool setHas(const uint64_t* set, int pos) {
+    return (set[pos / 64] >> (pos % 64)) & 1;
+}
+
+// Display form of a pattern set: the pattern itself, or "{p0, p1, ...}"
+static char* describePatterns(const char* const* patterns, int num_patterns) {
+    if (num_patterns == 1) {
+        char* text = xmalloc(strlen(patterns[0]) + 1);
+        strcpy(text, patterns[0]);
+        return text;
+    }
+    size_t len = 3;
+    for (int p = 0; p < num_patterns; p++) {
+        len += strlen(patterns[p]) + 2;
+    }
+    char* text = xmalloc(len);
+    strcpy(text, "{");
+    for (int p = 0; p < num_patterns; p++) {
+        if (p > 0) strcat(text, ", ");
+        strcat(text, patterns[p]);
+    }
+    strcat(text, "}");
+    return text;
+}
+
+bool buildPositions(const char* const* patterns, int num_patterns, PositionAutomaton* pa,
+                    char* err, size_t err_len) {
+    if (num_patterns < 1) {
+        if (err && err_len) snprintf(err, err_len, "No patterns given");
+        return false;
+    }
+    // Augment each pattern with its own end marker and join them:
+    // (r0)#0 | (r1)#1 | ...
+    Node* root = NULL;
+    Node** ends = xmalloc((size_t)num_patterns * sizeof(Node*));
+    CharSet none = {{0}};
+    for (int p = 0; p < num_patterns; p++) {
+        Parser ps = { patterns[p], patterns[p], err, err_len, false };
+        Node* tree = parseAlt(&ps);
+        if (!ps.failed && *ps.p == ')') {
+            parseError(&ps, "unmatched ')'");
+        }
+        if (ps.failed) {
+            if (num_patterns > 1 && err && err_len) {
+                char detail[256];
+                snprintf(detail, sizeof(detail), "%s", err);
+                snprintf(err, err_len, "Pattern %d: %s", p, detail);
+            }
+            freeTree(tree);
+            freeTree(root);
+            free(ends);
+            return false;
+        }
+        ends[p] = newLeaf(&none);
+        Node* augmented = newNode(NODE_CAT, tree, ends[p]);
+        root = root ? newNode(NODE_ALT, root, augmented) : augmented;
+    }
+
+    int num_positions = countLeaves(root);
+    if (num_positions > MAX_POSITIONS) {
+        if (err && err_len) {
+            snprintf(err, err_len, "Pattern has %d positions (limit %d)", num_positions, MAX_POSITIONS);
+        }
+        freeTree(root);
+        free(ends);
+        return false;
+    }
+
+    Node** leaves = xmalloc((size_t)num_positions * sizeof(Node*));
+    int count = 0;
+    collectLeaves(root, leaves, &count);
+    int* end_pos = xmalloc((size_t)num_patterns * sizeof(int));
+    for (int p = 0; p < num_patterns; p++) {
+        end_pos[p] = ends[p]->pos;
+    }
+    free(ends);
+
+    int words = (num_positions + 63) / 64;
+    uint64_t* followpos = xcalloc((size_t)num_positions * words, sizeof(uint64_t));
+    computePositions(root, followpos, words);
+    uint64_t* first = xmalloc((size_t)words * sizeof(uint64_t));
+    memcpy(first, root->firstpos, (size_t)words * sizeof(uint64_t));
+
+    // Alphabet = bytes used by any position; split it into classes of bytes
+    // that every position treats identically. Bytes outside the alphabet
+    // form one extra class (numbered last) that leads to the dead state.
+    int byte_class[256];
+    for (int b = 0; b < 256; b++) {
+        byte_class[b] = -1;
+        for (int i = 0; i < num_positions; i++) {
+            if (charsetHas(&leaves[i]->chars, (unsigned char)b)) {
+                byte_class[b] = 0;
+                break;
+            }
+        }
+    }
+    int num_classes = 0;
+    for (int i = 0; i < num_positions; i++) {
+        int remap[512];
+        int next_class = 0;
+        memset(remap, -1, sizeof(remap));
+        for (int b = 0; b < 256; b++) {
+            if (byte_class[b] < 0) continue;
+            int key = byte_class[b] * 2 + charsetHas(&leaves[i]->chars, (unsigned char)b);
+            if (remap[key] < 0) remap[key] = next_class++;
+            byte_class[b] = remap[key];
+        }
+        num_classes = next_class;
+    }
+
+    int num_symbols = 0;
+    int representative[257];
+    bool has_reject_class = false;
+    for (int b = 0; b < 256; b++) {
+        if (byte_class[b] < 0) {
+            has_reject_class = true;
+            continue;
+        }
+        representative[byte_class[b]] = b;
+        pa->symbols[num_symbols++] = (char)b;
+    }
+    for (int b = 0; b < 256; b++) {
+        if (byte_class[b] < 0) {
+            byte_class[b] = num_classes;
+            representative[num_classes] = b;
+        }
+        pa->class_map[b] = (unsigned char)byte_class[b];
+    }
+    if (has_reject_class) num_classes++;
+
+    uint64_t* class_positions = xcalloc((size_t)num_classes * words, sizeof(uint64_t));
+    for (int k = 0; k < num_classes; k++) {
+        for (int i = 0; i < num_positions; i++) {
+            if (charsetHas(&leaves[i]->chars, (unsigned char)representative[k])) {
+                class_positions[(size_t)k * words + i / 64] |= 1ULL << (i % 64);
+            }
+        }
+    }
+
+    free(leaves);
+    freeTree(root);
+
+    pa->num_positions = num_positions;
+    pa->words = words;
+    pa->followpos = followpos;
+    pa->first = first;
+    pa->num_symbols = num_symbols;
+    pa->num_classes = num_classes;
+    pa->class_positions = class_positions;
+    pa->num_patterns = num_patterns;
+    pa->end_pos = end_pos;
+    pa->description = describePatterns(patterns, num_patterns);
+    return true;
+}
+
+void freePositions(PositionAutomaton* pa) {
+    free(pa->followpos);
+    free(pa->first);
+    free(pa->class_positions);
+    free(pa->end_pos);
+    free(pa->description);
+    memset(pa, 0, sizeof(*pa));
+}
+
+// next = union of followpos(i) over positions i in set that match class k
+void positionsStep(const PositionAutomaton* pa, const uint64_t* set, int k, uint64_t* next) {
+    int words = pa->words;
+    const uint64_t* matching = pa->class_positions + (size_t)k * words;
+    memset(next, 0, (size_t)words * sizeof(uint64_t));
+    for (int w = 0; w < words; w++) {
+        uint64_t bits = set[w] & matching[w];
+        while (bits) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            unionInto(next, pa->followpos + (size_t)i * words, words);
+        }
+    }
+}
+
+bool positionsAccept(const PositionAutomaton* pa, const uint64_t* set, int pattern) {
+    return setHas(set, pa->end_pos[pattern]);
+}
+
+// ---------------------------------------------------------------------------
+// Eager compilation (subset construction)
+// ---------------------------------------------------------------------------
+
+// Mark state as accepting every pattern whose end marker is in set
+static void addAccepts(DFA* dfa, int state, const PositionAutomaton* pa, const uint64_t* set) {
+    for (int p = 0; p < pa->num_patterns; p++) {
+        if (positionsAccept(pa, set, p)) addAcceptingPattern(dfa, state, p);
+    }
+}
+
+bool compileRegex(const char* pattern, DFA* dfa, char* err, size_t err_len) {
+    return compilePatternSet(&pattern, 1, dfa, err, err_len);
+}
+
+bool compilePatternSet(const char* const* patterns, int num_patterns, DFA* dfa,
+                       char* err, size_t err_len) {
+    PositionAutomaton pa;
+    if (!buildPositions(patterns, num_patterns, &pa, err, err_len)) {
+        return false;
+    }
+    int words = pa.words;
+    int num_classes = pa.num_classes;
+
+    // Each DFA state is a set of positions
+    initDFA(dfa, pa.description, pa.symbols, pa.num_symbols, pa.class_map, num_classes, num_patterns);
+
+    StateSetMap map;
+    stateSetMapInit(&map, words);
+
+    bool added;
+    stateSetIntern(&map, pa.first, &added);
+    dfa->start_state = addState(dfa, false);
+    addAccepts(dfa, dfa->start_state, &pa, pa.first);
+
+    uint64_t* current = xmalloc((size_t)words * sizeof(uint64_t));
+    uint64_t* next = xmalloc((size_t)words * sizeof(uint64_t));
+    bool ok = true;
+
+    for (int s = 0; s < map.count && ok; s++) {
+        memcpy(current, stateSetAt(&map, s), (size_t)words * sizeof(uint64_t));
+
+        for (int k = 0; k < num_classes; k++) {
+            positionsStep(&pa, current, k, next);
+
+            int target = stateSetIntern(&map, next, &added);
+            if (added) {
+                if (map.count > REGEX_MAX_DFA_STATES) {
+                    if (err && err_len) {
+                        snprintf(err, err_len, "DFA exceeds %d states", REGEX_MAX_DFA_STATES);
+                    }
+                    ok = false;
+                    break;
+                }
+                addAccepts(dfa, addState(dfa, false), &pa, next);
+            }
+            dfa->transition_table[s * num_classes + k] = target;
+        }
+    }
+
+    free(current);
+    free(next);
+    stateSetMapFree(&map);
+    freePositions(&pa);
+
+    if (!ok) {
+        freeDFA(dfa);
+        return false;
+    }
+    dfa->dead_state = findDeadState(dfa);
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef REGEX_H
+#define REGEX_H
+
+#include "dfa.h"
+
+// Upper bound on DFA states produced by subset construction
+#define REGEX_MAX_DFA_STATES 65536
+
+// Compile a regular expression into a DFA (followpos + subset construction).
+//
+// Supported syntax: literals, '.', [a-z] / [^...] classes, escapes
+// (\n \t \r \d \w \s \xHH \uHHHH \u{H...} and escaped metacharacters),
+// grouping with (), alternation |, and the postfix operators * + ? {n} {n,}
+// {n,m}. Patterns are UTF-8: a non-ASCII character, and a class naming one,
+// is compiled into the byte sequences of its encoding, so the DFA still
+// steps one byte at a time.
+//
+// On success the DFA is initialised and owned by the caller (freeDFA).
+// On failure returns false and writes a message into err.
+bool compileRegex(const char* pattern, DFA* dfa, char* err, size_t err_len);
+
+// Compile several patterns into one DFA that recognises all of them in a
+// single scan. Each pattern gets its own end marker, so a state's accept
+// set (stateAcceptSet) lists the IDs (indices into patterns) of every
+// pattern that matches the input read so far. Syntax errors name the
+// offending pattern.
+bool compilePatternSet(const char* const* patterns, int num_patterns, DFA* dfa,
+                       char* err, size_t err_len);
+
+// Position automaton of a pattern set: the followpos form of
+// (r0)#0 | (r1)#1 | ..., from which DFA states (sets of positions) are
+// built either all at once (compilePatternSet) or on demand (lazy.h).
+typedef struct {
+    int num_positions;
+    int words;                   // 64-bit words per position set
+    uint64_t* followpos;         // num_positions sets
+    uint64_t* first;             // firstpos of the root: the start state
+    char symbols[256];
+    int num_symbols;
+    unsigned char class_map[256];
+    int num_classes;
+    uint64_t* class_positions;   // per class: positions matching its bytes
+    int num_patterns;
+    int* end_pos;                // per pattern: position of its end marker
+    char* description;
+} PositionAutomaton;
+
+// Parse the patterns and compute followpos and byte classes
+bool buildPositions(const char* const* patterns, int num_patterns, PositionAutomaton* pa,
+                    char* err, size_t err_len);
+
+// Release all memory owned by the position automaton
+void freePositions(PositionAutomaton* pa);
+
+// Set of positions reached from set on byte class k
+void positionsStep(const PositionAutomaton* pa, const uint64_t* set, int k, uint64_t* next);
+
+// Does a state with this position set accept pattern?
+bool positionsAccept(const PositionAutomaton* pa, const uint64_t* set, int pattern);
+
+#endif
@@ -0,0 +1,102 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dfa.h"
+#include "stateset.h"
+
+static uint64_t hashSet(const uint64_t* set, int words) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int w = 0; w < words; w++) {
+        h ^= set[w];
+        h *= 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static void mapRehash(StateSetMap* map, int num_slots) {
+    free(map->slots);
+    map->slots = xmalloc((size_t)num_slots * sizeof(int));
+    map->num_slots = num_slots;
+    memset(map->slots, -1, (size_t)num_slots * sizeof(int));
+
+    for (int i = 0; i < map->count; i++) {
+        size_t slot = hashSet(map->sets + (size_t)i * map->words, map->words) & (num_slots - 1);
+        while (map->slots[slot] >= 0) {
+            slot = (slot + 1) & (num_slots - 1);
+        }
+        map->slots[slot] = i;
+    }
+}
+
+// Index of set, or -1
+int stateSetFind(const StateSetMap* map, const uint64_t* set) {
+    size_t bytes = (size_t)map->words * sizeof(uint64_t);
+    size_t slot = hashSet(set, map->words) & (map->num_slots - 1);
+
+    while (map->slots[slot] >= 0) {
+        int i = map->slots[slot];
+        if (memcmp(map->sets + (size_t)i * map->words, set, bytes) == 0) {
+            return i;
+        }
+        slot = (slot + 1) & (map->num_slots - 1);
+    }
+    return -1;
+}
+
+// Return the index of set, inserting it if new
+int stateSetIntern(StateSetMap* map, const uint64_t* set, bool* added) {
+    size_t bytes = (size_t)map->words * sizeof(uint64_t);
+    size_t slot = hashSet(set, map->words) & (map->num_slots - 1);
+
+    while (map->slots[slot] >= 0) {
+        int i = map->slots[slot];
+        if (memcmp(map->sets + (size_t)i * map->words, set, bytes) == 0) {
+            *added = false;
+            return i;
+        }
+        slot = (slot + 1) & (map->num_slots - 1);
+    }
+
+    if (map->count == map->capacity) {
+        map->capacity = map->capacity ? map->capacity * 2 : 64;
+        map->sets = xrealloc(map->sets, (size_t)map->capacity * bytes);
+    }
+    int index = map->count++;
+    memcpy(map->sets + (size_t)index * map->words, set, bytes);
+    map->slots[slot] = index;
+
+    if (map->count * 2 > map->num_slots) {
+        mapRehash(map, map->num_slots * 2);
+    }
+    *added = true;
+    return index;
+}
+
+// Create an empty map
+void stateSetMapInit(StateSetMap* map, int words) {
+    map->words = words;
+    map->sets = NULL;
+    map->count = 0;
+    map->capacity = 0;
+    map->slots = NULL;
+    map->num_slots = 0;
+    mapRehash(map, 64);
+}
+
+// Release all memory owned by the map
+void stateSetMapFree(StateSetMap* map) {
+    free(map->sets);
+    free(map->slots);
+    memset(map, 0, sizeof(*map));
+}
+
+// Forget every set, keeping storage
+void stateSetMapClear(StateSetMap* map) {
+    map->count = 0;
+    memset(map->slots, -1, (size_t)map->num_slots * sizeof(int));
+}
+
+// The set stored at index
+const uint64_t* stateSetAt(const StateSetMap* map, int index) {
+    return map->sets + (size_t)index * map->words;
+}
@@ -0,0 +1,37 @@
+#ifndef STATESET_H
+#define STATESET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Interning hash map from position sets (bitsets of `words` 64-bit words)
+// to dense indices 0, 1, 2, ... in insertion order. Used by the eager
+// subset construction and by the lazy DFA's state cache.
+typedef struct {
+    int words;
+    uint64_t* sets;
+    int count;
+    int capacity;
+    int* slots;
+    int num_slots;
+} StateSetMap;
+
+// Create an empty map for sets of the given width
+void stateSetMapInit(StateSetMap* map, int words);
+
+// Release all memory owned by the map
+void stateSetMapFree(StateSetMap* map);
+
+// Forget every set (indices restart at 0); storage is kept for reuse
+void stateSetMapClear(StateSetMap* map);
+
+// Index of set, or -1 if it is not in the map
+int stateSetFind(const StateSetMap* map, const uint64_t* set);
+
+// Return the index of set, inserting it if new (*added tells which)
+int stateSetIntern(StateSetMap* map, const uint64_t* set, bool* added);
+
+// The set stored at index
+const uint64_t* stateSetAt(const StateSetMap* map, int index);
+
+#endif
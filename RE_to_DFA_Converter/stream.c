@@ -0,0 +1,204 @@
+#include <stdlib.h>
+#include <string.h>
+#include "stream.h"
+
+// Start a search for dfa's pattern anywhere in a stream
+void initDFAStream(DFAStream* stream, const DFA* dfa, StreamMode mode,
+                   StreamMatchFn on_match, void* user) {
+    int n = dfa->num_states;
+    stream->dfa = dfa;
+    stream->mode = mode;
+    stream->on_match = on_match;
+    stream->user = user;
+    stream->live = xcalloc((size_t)n, sizeof(bool));
+    stream->seen = xcalloc((size_t)n, sizeof(bool));
+    stream->capacity = n + 1;
+    stream->runs = xmalloc((size_t)stream->capacity * sizeof(StreamRun));
+    stream->num_runs = 0;
+    stream->pending = NULL;
+    stream->num_pending = 0;
+    stream->pending_capacity = 0;
+    stream->free_pending = -1;
+    stream->offset = 0;
+    stream->matches = 0;
+
+    // Live states: accepting, or with a transition into a live state
+    for (int s = 0; s < n; s++) {
+        stream->live[s] = dfa->accepting_states[s];
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int s = 0; s < n; s++) {
+            if (stream->live[s]) continue;
+            for (int k = 0; k < dfa->num_classes; k++) {
+                if (stream->live[dfa->transition_table[s * dfa->num_classes + k]]) {
+                    stream->live[s] = true;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void reportMatch(DFAStream* stream, size_t start, size_t end) {
+    stream->matches++;
+    if (stream->on_match) stream->on_match(stream->user, start, end);
+}
+
+// New pending match (not yet in any list)
+static int newPending(DFAStream* stream, size_t start, size_t end) {
+    int m = stream->free_pending;
+    if (m >= 0) {
+        stream->free_pending = stream->pending[m].next;
+    } else {
+        if (stream->num_pending == stream->pending_capacity) {
+            stream->pending_capacity = stream->pending_capacity ? stream->pending_capacity * 2 : 16;
+            stream->pending = xrealloc(stream->pending,
+                                       (size_t)stream->pending_capacity * sizeof(StreamMatch));
+        }
+        m = stream->num_pending++;
+    }
+    stream->pending[m].start = start;
+    stream->pending[m].end = end;
+    stream->pending[m].next = -1;
+    return m;
+}
+
+// Put the pending list first..last on the free list
+static void dropPending(DFAStream* stream, int first, int last) {
+    if (first < 0) return;
+    stream->pending[last].next = stream->free_pending;
+    stream->free_pending = first;
+}
+
+// Run is finished: its own match (if any) and the matches pending behind
+// it now wait for the live run before it, kept at runs[before], or are
+// decided when there is none (before < 0)
+static void finishRun(DFAStream* stream, const StreamRun* run, int before) {
+    int first = run->first_pending, last = run->last_pending;
+    if (run->matched) {
+        int m = newPending(stream, run->start, run->end);
+        stream->pending[m].next = first;
+        first = m;
+        if (last < 0) last = m;
+    }
+    if (first < 0) return;
+
+    if (before >= 0) {
+        StreamRun* prev = &stream->runs[before];
+        if (prev->last_pending >= 0) {
+            stream->pending[prev->last_pending].next = first;
+        } else {
+            prev->first_pending = first;
+        }
+        prev->last_pending = last;
+        return;
+    }
+    for (int m = first; m >= 0; m = stream->pending[m].next) {
+        reportMatch(stream, stream->pending[m].start, stream->pending[m].end);
+    }
+    dropPending(stream, first, last);
+}
+
+// Feed the next chunk of the stream
+void dfa_stream_feed(DFAStream* stream, const char* buf, size_t len) {
+    const DFA* dfa = stream->dfa;
+    const int* table = dfa->transition_table;
+    int k = dfa->num_classes;
+    int start_state = dfa->start_state;
+    bool start_live = stream->live[start_state];
+
+    // Is some run already in the start state? It covers a run starting now.
+    bool start_taken = false;
+    for (int r = 0; r < stream->num_runs; r++) {
+        if (stream->runs[r].state == start_state) start_taken = true;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        size_t pos = stream->offset + i;
+
+        if (start_live && !start_taken) {
+            if (stream->num_runs == stream->capacity) {
+                stream->capacity *= 2;
+                stream->runs = xrealloc(stream->runs, (size_t)stream->capacity * sizeof(StreamRun));
+            }
+            StreamRun* run = &stream->runs[stream->num_runs++];
+            run->state = start_state;
+            run->start = pos;
+            run->matched = false;
+            run->first_pending = -1;
+            run->last_pending = -1;
+        }
+
+        // Step every run in start order. A run that matches here drops all
+        // later runs, which started inside its match; runs that meet keep
+        // the earliest start, and runs that can no longer match finish.
+        int cls = dfa->class_map[(unsigned char)buf[i]];
+        int kept = 0;
+        bool extended = false;
+        for (int r = 0; r < stream->num_runs; r++) {
+            StreamRun run = stream->runs[r];
+            if (extended) {
+                dropPending(stream, run.first_pending, run.last_pending);
+                continue;
+            }
+            int next = table[run.state * k + cls];
+            if (!stream->live[next] || stream->seen[next]) {
+                finishRun(stream, &run, kept - 1);
+                continue;
+            }
+            stream->seen[next] = true;
+            run.state = next;
+            if (dfa->accepting_states[next]) {
+                run.end = pos + 1;
+                run.matched = true;
+                dropPending(stream, run.first_pending, run.last_pending);
+                run.first_pending = -1;
+                run.last_pending = -1;
+                extended = true;
+            }
+            stream->runs[kept++] = run;
+        }
+        stream->num_runs = kept;
+        start_taken = stream->seen[start_state];
+        for (int r = 0; r < kept; r++) {
+            stream->seen[stream->runs[r].state] = false;
+        }
+
+        // The run that matched is the last one kept; earliest mode reports
+        // it at once and restarts, so it never has pending matches
+        if (stream->mode == STREAM_EARLIEST && extended) {
+            reportMatch(stream, stream->runs[kept - 1].start, pos + 1);
+            stream->num_runs = 0;
+            start_taken = false;
+        }
+    }
+    stream->offset += len;
+}
+
+// End of stream: every run is finished, so every match is decided
+void dfa_stream_finish(DFAStream* stream) {
+    for (int r = 0; r < stream->num_runs; r++) {
+        finishRun(stream, &stream->runs[r], -1);
+    }
+    stream->num_runs = 0;
+    stream->offset = 0;
+}
+
+// Release all memory owned by the stream
+void freeDFAStream(DFAStream* stream) {
+    free(stream->live);
+    free(stream->seen);
+    free(stream->runs);
+    free(stream->pending);
+    stream->live = NULL;
+    stream->seen = NULL;
+    stream->runs = NULL;
+    stream->pending = NULL;
+    stream->num_runs = 0;
+    stream->num_pending = 0;
+    stream->pending_capacity = 0;
+    stream->free_pending = -1;
+}
@@ -0,0 +1,81 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "dfa.h"
+
+// Which matches a stream search reports (both are non-overlapping and
+// never report empty matches)
+typedef enum {
+    STREAM_EARLIEST,         // as soon as any match ends, then restart after it
+    STREAM_LEFTMOST_LONGEST  // POSIX: leftmost start, longest end for that start
+} StreamMode;
+
+// Called for each match with absolute stream offsets [start, end)
+typedef void (*StreamMatchFn)(void* user, size_t start, size_t end);
+
+// A finished match that waits for the runs before it (leftmost-longest
+// only); pending matches are linked into lists in start order
+typedef struct {
+    size_t start;
+    size_t end;
+    int next;        // next match in the list, -1 at its end
+} StreamMatch;
+
+// One anchored run of the DFA, started at a stream offset
+typedef struct {
+    int state;       // current state
+    size_t start;
+    size_t end;      // end of the longest match so far (valid when matched)
+    bool matched;
+    int first_pending;       // pending matches that started after this run
+    int last_pending;        // and before the next one (-1: none)
+} StreamRun;
+
+// Resumable unanchored search. Every offset starts an anchored run of the
+// DFA. Once a run matches, the runs that started inside its match are
+// dropped: they can only be reported if it is not, and the run that
+// prevents that matches past them too. Among the remaining runs, those
+// that reach the same state have the same future, so only the one that
+// started first is kept, which bounds the live runs by the number of
+// states. Runs in states that cannot reach an accepting state are dropped.
+// A finished match is reported once no live run started before it;
+// until then it waits in the pending list of the live run just before it
+// and costs nothing per byte. Only runs and pending matches are kept
+// between chunks, never input.
+typedef struct {
+    const DFA* dfa;          // borrowed; must outlive the stream
+    StreamMode mode;
+    StreamMatchFn on_match;
+    void* user;
+    bool* live;              // state can still reach an accepting state
+    bool* seen;              // per-step merge marks, indexed by state
+    StreamRun* runs;         // live runs, ordered by start offset
+    int num_runs;
+    int capacity;
+    StreamMatch* pending;    // storage for all pending lists
+    int num_pending;         // entries of pending in use or on the free list
+    int pending_capacity;
+    int free_pending;        // first free entry of pending, -1 if none
+    size_t offset;           // bytes fed so far
+    size_t matches;          // matches reported so far
+} DFAStream;
+
+// Start a search for dfa's pattern anywhere in a stream
+void initDFAStream(DFAStream* stream, const DFA* dfa, StreamMode mode,
+                   StreamMatchFn on_match, void* user);
+
+// Feed the next len bytes of the stream; matches are reported as soon as
+// they are decided (leftmost-longest holds them back while an earlier run
+// may still match, possibly until a later chunk)
+void dfa_stream_feed(DFAStream* stream, const char* buf, size_t len);
+
+// End of stream: report matches still pending and reset the offset so
+// the stream can be reused
+void dfa_stream_finish(DFAStream* stream);
+
+// Release all memory owned by the stream
+void freeDFAStream(DFAStream* stream);
+
+#endif
@@ -0,0 +1,357 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "svglayout.h"
+
+#define NODE_RADIUS 24
+#define LAYER_GAP 170
+#define NODE_GAP 120
+#define MARGIN 60
+#define TITLE_HEIGHT 50
+#define ORDERING_SWEEPS 8
+#define MAX_BEND 150
+
+typedef struct {
+    int from;
+    int to;
+} Edge;
+
+typedef struct {
+    double key;
+    int state;
+} OrderKey;
+
+// Write text with XML special characters escaped (control bytes dropped)
+static void writeXmlEscaped(FILE* file, const char* text) {
+    for (; *text; text++) {
+        switch (*text) {
+            case '&': fputs("&amp;", file); break;
+            case '<': fputs("&lt;", file); break;
+            case '>': fputs("&gt;", file); break;
+            case '"': fputs("&quot;", file); break;
+            default:
+                if ((unsigned char)*text >= ' ') fputc(*text, file);
+                break;
+        }
+    }
+}
+
+// malloc that exits on failure (this module is shared by both tools and
+// uses neither one's allocation helpers)
+static void* allocOrDie(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        perror("Error allocating SVG layout");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static int compareKeys(const void* a, const void* b) {
+    const OrderKey* x = a;
+    const OrderKey* y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->state - y->state;
+}
+
+// Reorder one layer by the mean position of each state's neighbours in
+// layer ref_layer (states without such neighbours keep their position)
+static void orderLayer(int* members, int count, const int* layer, int ref_layer,
+                       const int* position, const int* adj_start, const int* adj,
+                       OrderKey* keys) {
+    for (int m = 0; m < count; m++) {
+        int s = members[m];
+        double sum = 0;
+        int n = 0;
+        for (int a = adj_start[s]; a < adj_start[s + 1]; a++) {
+            if (layer[adj[a]] == ref_layer) {
+                sum += position[adj[a]];
+                n++;
+            }
+        }
+        keys[m].key = n > 0 ? sum / n : position[s];
+        keys[m].state = s;
+    }
+    qsort(keys, (size_t)count, sizeof(OrderKey), compareKeys);
+    for (int m = 0; m < count; m++) {
+        members[m] = keys[m].state;
+    }
+}
+
+// Control point of the quadratic curve for edge u -> v. Curves bend to
+// the left of their direction, so an edge and its reverse separate.
+// Edges to the next layer are straight unless the reverse edge exists;
+// back edges, same-layer edges and edges skipping layers bend further
+// with their span to clear the states in between.
+static void edgeControl(const StateDiagram* d, const int* layer, const double* x, const double* y,
+                        int u, int v, double* cx, double* cy) {
+    bool reverse = false;
+    for (int j = 0; j < d->num_symbols && !reverse; j++) {
+        reverse = d->next(d->graph, v, (unsigned char)d->symbols[j]) == u;
+    }
+    int span = layer[v] - layer[u];
+    double bend = span == 1 ? (reverse ? 22 : 0) : 35 + 18 * abs(span);
+    if (bend > MAX_BEND) bend = MAX_BEND;
+
+    double dx = x[v] - x[u], dy = y[v] - y[u];
+    double length = sqrt(dx * dx + dy * dy);
+    *cx = (x[u] + x[v]) / 2 + dy / length * bend * 2;
+    *cy = (y[u] + y[v]) / 2 - dx / length * bend * 2;
+}
+
+// Draw the diagram as an SVG image
+void writeSvgDiagram(const StateDiagram* d, const char* filename) {
+    int n = d->num_states;
+
+    // Distinct edges, skipping the dead state (one per state pair)
+    int capacity = n * 2 + 1, num_edges = 0;
+    Edge* edges = allocOrDie((size_t)capacity * sizeof(Edge));
+    int* emitted = allocOrDie((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) emitted[s] = -1;
+    for (int s = 0; s < n; s++) {
+        if (s == d->dead_state) continue;
+        for (int j = 0; j < d->num_symbols; j++) {
+            int t = d->next(d->graph, s, (unsigned char)d->symbols[j]);
+            if (t == d->dead_state || emitted[t] == s) continue;
+            emitted[t] = s;
+            if (num_edges == capacity) {
+                capacity *= 2;
+                edges = realloc(edges, (size_t)capacity * sizeof(Edge));
+                if (!edges) {
+                    perror("Error allocating SVG layout");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            edges[num_edges].from = s;
+            edges[num_edges].to = t;
+            num_edges++;
+        }
+    }
+
+    // Undirected adjacency (CSR) for ordering
+    int* adj_start = allocOrDie(((size_t)n + 1) * sizeof(int));
+    memset(adj_start, 0, ((size_t)n + 1) * sizeof(int));
+    int* adj = allocOrDie((size_t)num_edges * 2 * sizeof(int) + 1);
+    for (int e = 0; e < num_edges; e++) {
+        adj_start[edges[e].from + 1]++;
+        adj_start[edges[e].to + 1]++;
+    }
+    for (int s = 0; s < n; s++) adj_start[s + 1] += adj_start[s];
+    int* fill = allocOrDie((size_t)n * sizeof(int));
+    memcpy(fill, adj_start, (size_t)n * sizeof(int));
+    for (int e = 0; e < num_edges; e++) {
+        adj[fill[edges[e].from]++] = edges[e].to;
+        adj[fill[edges[e].to]++] = edges[e].from;
+    }
+
+    // 1. Layers: BFS distance from the start state; states the BFS does
+    //    not reach (none after minimization) go in one extra layer
+    int* layer = allocOrDie((size_t)n * sizeof(int));
+    int* queue = allocOrDie((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) layer[s] = -1;
+    int head = 0, tail = 0, num_layers = 1;
+    layer[d->start_state] = 0;
+    queue[tail++] = d->start_state;
+    while (head < tail) {
+        int s = queue[head++];
+        for (int j = 0; j < d->num_symbols; j++) {
+            int t = d->next(d->graph, s, (unsigned char)d->symbols[j]);
+            if (t == d->dead_state || layer[t] >= 0) continue;
+            layer[t] = layer[s] + 1;
+            if (layer[t] + 1 > num_layers) num_layers = layer[t] + 1;
+            queue[tail++] = t;
+        }
+    }
+    bool has_unreached = false;
+    for (int s = 0; s < n; s++) {
+        if (s != d->dead_state && layer[s] < 0) {
+            layer[s] = num_layers;
+            has_unreached = true;
+        }
+    }
+    if (has_unreached) num_layers++;
+
+    // Layer members in BFS order (then unreached states), as CSR
+    int* layer_start = allocOrDie(((size_t)num_layers + 1) * sizeof(int));
+    memset(layer_start, 0, ((size_t)num_layers + 1) * sizeof(int));
+    int* members = allocOrDie((size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        if (s != d->dead_state) layer_start[layer[s] + 1]++;
+    }
+    for (int l = 0; l < num_layers; l++) layer_start[l + 1] += layer_start[l];
+    memcpy(fill, layer_start, (size_t)num_layers * sizeof(int));
+    for (int i = 0; i < tail; i++) members[fill[layer[queue[i]]]++] = queue[i];
+    for (int s = 0; s < n; s++) {
+        if (s != d->dead_state && has_unreached && layer[s] == num_layers - 1) {
+            members[fill[layer[s]]++] = s;
+        }
+    }
+
+    // 2. Order within layers: barycenter sweeps, alternating direction
+    int* position = allocOrDie((size_t)n * sizeof(int));
+    OrderKey* keys = allocOrDie((size_t)n * sizeof(OrderKey));
+    int widest = 1;
+    for (int l = 0; l < num_layers; l++) {
+        int count = layer_start[l + 1] - layer_start[l];
+        if (count > widest) widest = count;
+        for (int m = 0; m < count; m++) position[members[layer_start[l] + m]] = m;
+    }
+    for (int sweep = 0; sweep < ORDERING_SWEEPS; sweep++) {
+        bool forward = sweep % 2 == 0;
+        for (int i = 1; i < num_layers; i++) {
+            int l = forward ? i : num_layers - 1 - i;
+            int ref = forward ? l - 1 : l + 1;
+            int count = layer_start[l + 1] - layer_start[l];
+            orderLayer(members + layer_start[l], count, layer, ref, position, adj_start, adj, keys);
+            for (int m = 0; m < count; m++) position[members[layer_start[l] + m]] = m;
+        }
+    }
+
+    // 3. Coordinates: layers left to right, each centred vertically; then
+    //    shift everything below the title, leaving room for self-loops
+    //    above states and for curves that bend past the outer rows
+    double* x = allocOrDie((size_t)n * sizeof(double));
+    double* y = allocOrDie((size_t)n * sizeof(double));
+    for (int l = 0; l < num_layers; l++) {
+        int count = layer_start[l + 1] - layer_start[l];
+        for (int m = 0; m < count; m++) {
+            int s = members[layer_start[l] + m];
+            x[s] = MARGIN + 60 + l * LAYER_GAP;
+            y[s] = (m + (widest - count) / 2.0) * NODE_GAP;
+        }
+    }
+    double min_y = -NODE_RADIUS - 60, max_y = (widest - 1) * NODE_GAP + NODE_RADIUS + 20;
+    for (int e = 0; e < num_edges; e++) {
+        int u = edges[e].from, v = edges[e].to;
+        if (u == v) continue;
+        double cx, cy;
+        edgeControl(d, layer, x, y, u, v, &cx, &cy);
+        double peak = (y[u] + y[v]) / 4 + cy / 2;
+        if (peak - 20 < min_y) min_y = peak - 20;
+        if (peak + 20 > max_y) max_y = peak + 20;
+    }
+    double top = MARGIN + TITLE_HEIGHT - min_y;
+    for (int s = 0; s < n; s++) {
+        if (s != d->dead_state) y[s] += top;
+    }
+    double width = MARGIN * 2 + 60 + (num_layers - 1) * LAYER_GAP + NODE_RADIUS * 4;
+    double height = MARGIN * 2 + TITLE_HEIGHT + (max_y - min_y);
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        perror("Error creating SVG file");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%.0f\" height=\"%.0f\" "
+                  "viewBox=\"0 0 %.0f %.0f\" font-family=\"Arial, sans-serif\">\n",
+            width, height, width, height);
+    fprintf(file, "  <defs>\n");
+    fprintf(file, "    <marker id=\"arrow\" viewBox=\"0 0 10 10\" refX=\"10\" refY=\"5\" "
+                  "markerWidth=\"8\" markerHeight=\"8\" orient=\"auto\">\n");
+    fprintf(file, "      <path d=\"M0,0 L10,5 L0,10 z\" fill=\"black\"/>\n");
+    fprintf(file, "    </marker>\n");
+    fprintf(file, "  </defs>\n");
+    fprintf(file, "  <rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n");
+    fprintf(file, "  <text x=\"%.0f\" y=\"%d\" font-size=\"18\" font-weight=\"bold\" text-anchor=\"middle\">"
+                  "DFA for Regular Expression: ", width / 2, MARGIN);
+    writeXmlEscaped(file, d->title);
+    fprintf(file, "</text>\n");
+
+    // Start arrow
+    int start = d->start_state;
+    fprintf(file, "  <line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" stroke=\"black\" "
+                  "marker-end=\"url(#arrow)\"/>\n",
+            x[start] - NODE_RADIUS - 50, y[start], x[start] - NODE_RADIUS, y[start]);
+    fprintf(file, "  <text x=\"%.1f\" y=\"%.1f\" font-size=\"12\" text-anchor=\"middle\">start</text>\n",
+            x[start] - NODE_RADIUS - 25, y[start] - 6);
+
+    // Edges (drawn before states so arrows end at the circle outline)
+    char label[DIAGRAM_LABEL_LEN];
+    fprintf(file, "  <g fill=\"none\" stroke=\"black\" stroke-width=\"1.2\">\n");
+    for (int e = 0; e < num_edges; e++) {
+        int u = edges[e].from, v = edges[e].to;
+        if (u == v) {
+            // Self-loop above the state
+            fprintf(file, "    <path d=\"M%.1f,%.1f C%.1f,%.1f %.1f,%.1f %.1f,%.1f\" stroke-width=\"2\" "
+                          "marker-end=\"url(#arrow)\"/>\n",
+                    x[u] - 10, y[u] - NODE_RADIUS + 2, x[u] - 35, y[u] - NODE_RADIUS - 45,
+                    x[u] + 35, y[u] - NODE_RADIUS - 45, x[u] + 10, y[u] - NODE_RADIUS + 2);
+            continue;
+        }
+        double cx, cy;
+        edgeControl(d, layer, x, y, u, v, &cx, &cy);
+
+        // Trim both ends to the circle outlines
+        double ux = cx - x[u], uy = cy - y[u], ul = sqrt(ux * ux + uy * uy);
+        double vx = cx - x[v], vy = cy - y[v], vl = sqrt(vx * vx + vy * vy);
+        fprintf(file, "    <path d=\"M%.1f,%.1f Q%.1f,%.1f %.1f,%.1f\" marker-end=\"url(#arrow)\"/>\n",
+                x[u] + ux / ul * NODE_RADIUS, y[u] + uy / ul * NODE_RADIUS, cx, cy,
+                x[v] + vx / vl * (NODE_RADIUS + 1), y[v] + vy / vl * (NODE_RADIUS + 1));
+    }
+    fprintf(file, "  </g>\n");
+
+    // Edge labels, at the middle of each curve
+    fprintf(file, "  <g font-size=\"12\" text-anchor=\"middle\" stroke=\"white\" stroke-width=\"3\" "
+                  "paint-order=\"stroke\">\n");
+    for (int e = 0; e < num_edges; e++) {
+        int u = edges[e].from, v = edges[e].to;
+        double lx = x[u], ly = y[u] - NODE_RADIUS - 38;
+        if (u != v) {
+            // Midpoint of the quadratic curve
+            double cx, cy;
+            edgeControl(d, layer, x, y, u, v, &cx, &cy);
+            lx = (x[u] + x[v]) / 4 + cx / 2;
+            ly = (y[u] + y[v]) / 4 + cy / 2 - 4;
+        }
+        diagramEdgeLabel(d, u, v, label);
+        fprintf(file, "    <text x=\"%.1f\" y=\"%.1f\">", lx, ly);
+        writeXmlEscaped(file, label);
+        fprintf(file, "</text>\n");
+    }
+    fprintf(file, "  </g>\n");
+
+    // States
+    fprintf(file, "  <g font-size=\"14\" text-anchor=\"middle\" stroke=\"black\">\n");
+    for (int s = 0; s < n; s++) {
+        if (s == d->dead_state) continue;
+        const char* fill_color = d->accepting[s] ? "lightgreen" : "lightblue";
+        fprintf(file, "    <circle cx=\"%.1f\" cy=\"%.1f\" r=\"%d\" fill=\"%s\"/>\n",
+                x[s], y[s], NODE_RADIUS, fill_color);
+        if (d->accepting[s]) {
+            fprintf(file, "    <circle cx=\"%.1f\" cy=\"%.1f\" r=\"%d\" fill=\"none\"/>\n",
+                    x[s], y[s], NODE_RADIUS - 4);
+        }
+        fprintf(file, "    <text x=\"%.1f\" y=\"%.1f\" stroke=\"none\">", x[s], y[s] + 5);
+        writeXmlEscaped(file, d->state_name(d->graph, s));
+        fprintf(file, "</text>\n");
+        if (d->accepting[s] && d->state_note) {
+            // Note (e.g. the pattern IDs the state reports), below it
+            d->state_note(d->graph, s, label);
+            if (label[0]) {
+                fprintf(file, "    <text x=\"%.1f\" y=\"%.1f\" font-size=\"11\" stroke=\"none\">",
+                        x[s], y[s] + NODE_RADIUS + 14);
+                writeXmlEscaped(file, label);
+                fprintf(file, "</text>\n");
+            }
+        }
+    }
+    fprintf(file, "  </g>\n");
+    fprintf(file, "</svg>\n");
+    fclose(file);
+
+    free(edges);
+    free(emitted);
+    free(adj_start);
+    free(adj);
+    free(fill);
+    free(layer);
+    free(queue);
+    free(layer_start);
+    free(members);
+    free(position);
+    free(keys);
+    free(x);
+    free(y);
+}
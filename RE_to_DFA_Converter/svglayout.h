@@ -0,0 +1,19 @@
+#ifndef SVGLAYOUT_H
+#define SVGLAYOUT_H
+
+#include "diagram.h"
+
+// Draw the diagram as a standalone SVG image, in process (no Graphviz).
+// Layered layout, left to right like writeDotDiagram:
+//   1. each state's layer is its BFS distance from the start state
+//   2. states within a layer are ordered by the barycenter of their
+//      neighbours in the adjacent layer, sweeping back and forth to
+//      reduce crossings
+//   3. one curved edge per state pair, labelled by diagramEdgeLabel;
+//      back edges and edges skipping layers bend further to clear the
+//      states in between, and self-loops sit above their state
+// Layout is linear in states and edges per sweep, so DFAs with thousands
+// of states render in milliseconds.
+void writeSvgDiagram(const StateDiagram* diagram, const char* filename);
+
+#endif
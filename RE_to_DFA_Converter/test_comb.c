@@ -0,0 +1,130 @@
+// Regression test: comb tables must agree with the dense table
+//
+//   gcc -g -fsanitize=address test_comb.c comb.c dfa.c regex.c minimize.c stateset.c -o test_comb
+//   ./test_comb
+//
+// Builds the comb table of sparse and dense DFAs, compiled from regexes
+// and generated at random, and checks comb_next against the dense table
+// for every state and class. Dense many-state tables fill the slot array
+// up to its capacity, where buildCombTable once scanned past the end (run
+// under AddressSanitizer to catch that). Also checks that selectCombTable
+// keeps a table only when it beats the narrow dense one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "comb.h"
+#include "dfa.h"
+#include "regex.h"
+#include "minimize.h"
+
+static const char* patterns[] = {
+    "(a|b)*abb",
+    "[a-z]+@[a-z]+\\.(com|org)",
+    "a*|(a((|a{2,}(bbb)ca)[^a]?a|(a(b?a?|a*a+)bb{3,})|b+b?)+)c|c[ab]{1}(((c+cb|(b*)*)ab*|bb|"
+    "(a{3}(a+)c|)c*bb)()+|[a-c]((|c?c)c)?)+(bc?c(|)+|ac{1}ca|a?)",
+    "(foo|bar|baz)[0-9]{2,4}(x|yz)*",
+};
+
+// xorshift32: the same sequence on every platform
+static unsigned nextRandom(unsigned* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Random DFA over num_symbols symbols; each transition differs from the
+// state's first one with probability percent / 100
+static void randomDFA(DFA* dfa, int num_states, int num_symbols, int percent, unsigned* seed) {
+    char symbols[64];
+    for (int i = 0; i < num_symbols; i++) symbols[i] = (char)('!' + i);
+    initDFA(dfa, "random", symbols, num_symbols, NULL, 0, 1);
+    for (int s = 0; s < num_states; s++) addState(dfa, s % 7 == 0);
+    int k = dfa->num_classes;
+    for (int s = 0; s < num_states; s++) {
+        int fallback = nextRandom(seed) % num_states;
+        for (int j = 0; j < k; j++) {
+            bool other = nextRandom(seed) % 100 < (unsigned)percent;
+            dfa->transition_table[(size_t)s * k + j] = other ? (int)(nextRandom(seed) % num_states) : fallback;
+        }
+    }
+}
+
+// Compare the comb table of dfa with its dense table; returns the number
+// of mismatches (after printing the first)
+static int checkDFA(const DFA* dfa, const char* name) {
+    int errors = 0;
+    CombTable comb;
+    buildCombTable(dfa, &comb);
+    for (int s = 0; s < dfa->num_states; s++) {
+        for (int j = 0; j < dfa->num_classes; j++) {
+            int expected = dfa->transition_table[(size_t)s * dfa->num_classes + j];
+            if (comb_next(&comb, s, j) != expected && errors++ == 0) {
+                fprintf(stderr, "%s: state %d class %d goes to %d, not %d\n",
+                        name, s, j, comb_next(&comb, s, j), expected);
+            }
+        }
+    }
+    size_t built = combTableBytes(&comb);
+    if (combTableMinBytes(dfa) > built) {
+        fprintf(stderr, "%s: lower bound %zu exceeds the comb table's %zu bytes\n",
+                name, combTableMinBytes(dfa), built);
+        errors++;
+    }
+    freeCombTable(&comb);
+
+    bool compressed = selectCombTable(dfa, &comb);
+    if (compressed != (built < narrowTableBytes(dfa))) {
+        fprintf(stderr, "%s: selectCombTable %s a %zu-byte comb table against %zu dense bytes\n",
+                name, compressed ? "kept" : "rejected", built, narrowTableBytes(dfa));
+        errors++;
+    }
+    if (compressed) freeCombTable(&comb);
+
+    printf("  %-12s %6d states %4d classes %6.1f%% stored %10zu comb bytes %s\n",
+           name, dfa->num_states, dfa->num_classes, 100.0 * transitionDensity(dfa), built,
+           errors ? "FAILED" : "ok");
+    return errors;
+}
+
+int main(void) {
+    int errors = 0;
+    char name[32];
+
+    for (size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+        DFA dfa;
+        char error[512];
+        if (!compileRegex(patterns[i], &dfa, error, sizeof(error))) {
+            fprintf(stderr, "Error: %s\n", error);
+            return EXIT_FAILURE;
+        }
+        MinimizeReport report;
+        minimizeDFA(&dfa, &report);
+        snprintf(name, sizeof(name), "regex %zu", i);
+        errors += checkDFA(&dfa, name);
+        freeDFA(&dfa);
+    }
+
+    static const int shapes[][3] = {
+        // states, symbols, percent of transitions away from the default
+        { 3000, 40, 100 },
+        { 3000, 40, 50 },
+        { 5000, 12, 5 },
+        { 200, 60, 100 },
+    };
+    unsigned seed = 12345;
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        DFA dfa;
+        randomDFA(&dfa, shapes[i][0], shapes[i][1], shapes[i][2], &seed);
+        snprintf(name, sizeof(name), "random %zu", i);
+        errors += checkDFA(&dfa, name);
+        freeDFA(&dfa);
+    }
+
+    if (errors) {
+        fprintf(stderr, "%d mismatches\n", errors);
+        return EXIT_FAILURE;
+    }
+    printf("All comb tables match their dense tables\n");
+    return 0;
+}
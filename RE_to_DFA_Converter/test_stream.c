@@ -0,0 +1,198 @@
+// Regression test: stream search against a brute-force scan
+//
+//   gcc -g -fsanitize=address test_stream.c stream.c dfa.c regex.c minimize.c stateset.c -o test_stream
+//   ./test_stream [cases]
+//
+// Compiles random patterns over {a, b, c}, feeds random inputs to a
+// DFAStream in random chunks, and compares the matches of both modes with
+// a direct scan that tries every start offset:
+//   leftmost-longest  first start with a non-empty match, its longest end,
+//                     then continue at that end
+//   earliest          first end of any non-empty match, with the first
+//                     start that ends there, then continue at that end
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dfa.h"
+#include "regex.h"
+#include "minimize.h"
+#include "stream.h"
+
+#define MAX_MATCHES 512
+
+typedef struct {
+    size_t start[MAX_MATCHES];
+    size_t end[MAX_MATCHES];
+    int count;
+} MatchList;
+
+static void addMatch(void* user, size_t start, size_t end) {
+    MatchList* list = user;
+    if (list->count < MAX_MATCHES) {
+        list->start[list->count] = start;
+        list->end[list->count] = end;
+    }
+    list->count++;
+}
+
+// xorshift32: the same sequence on every platform
+static unsigned nextRandom(unsigned* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Append a random regex over {a, b, c} with about depth levels of nesting
+static void randomPattern(char* out, size_t size, int depth, unsigned* seed) {
+    size_t len = strlen(out);
+    if (len + 16 > size) return;
+    int choice = depth > 0 ? nextRandom(seed) % 6 : 0;
+    switch (choice) {
+        case 0:
+            out[len] = "abc"[nextRandom(seed) % 3];
+            out[len + 1] = '\0';
+            break;
+        case 1:
+        case 2:
+            randomPattern(out, size, depth - 1, seed);
+            randomPattern(out, size, depth - 1, seed);
+            break;
+        case 3:
+            strcat(out, "(");
+            randomPattern(out, size, depth - 1, seed);
+            strcat(out, "|");
+            randomPattern(out, size, depth - 1, seed);
+            strcat(out, ")");
+            break;
+        default:
+            strcat(out, "(");
+            randomPattern(out, size, depth - 1, seed);
+            strcat(out, choice == 4 ? ")*" : nextRandom(seed) % 2 ? ")+" : ")?");
+            break;
+    }
+}
+
+// Longest (or, with shortest, first) end of a non-empty match of the
+// anchored DFA from start, or 0 if there is none
+static size_t matchEnd(const DFA* dfa, const char* text, size_t len, size_t start, bool shortest) {
+    int state = dfa->start_state;
+    size_t end = 0;
+    for (size_t i = start; i < len; i++) {
+        state = dfa->transition_table[state * dfa->num_classes + dfa->class_map[(unsigned char)text[i]]];
+        if (state == dfa->dead_state) break;
+        if (dfa->accepting_states[state]) {
+            end = i + 1;
+            if (shortest) break;
+        }
+    }
+    return end;
+}
+
+static void bruteForce(const DFA* dfa, const char* text, size_t len, StreamMode mode, MatchList* list) {
+    size_t pos = 0;
+    while (pos < len) {
+        size_t best_start = 0, best_end = 0;
+        for (size_t s = pos; s < len; s++) {
+            size_t end = matchEnd(dfa, text, len, s, mode == STREAM_EARLIEST);
+            if (end == 0) continue;
+            if (mode == STREAM_LEFTMOST_LONGEST) {
+                best_start = s;
+                best_end = end;
+                break;
+            }
+            if (best_end == 0 || end < best_end) {
+                best_start = s;
+                best_end = end;
+            }
+        }
+        if (best_end == 0) break;
+        addMatch(list, best_start, best_end);
+        pos = best_end;
+    }
+}
+
+static void printList(const char* name, const MatchList* list) {
+    fprintf(stderr, "  %-8s", name);
+    for (int i = 0; i < list->count && i < MAX_MATCHES; i++) {
+        fprintf(stderr, " [%zu,%zu)", list->start[i], list->end[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+// Search text with a stream fed in random chunks; returns whether it found
+// the brute-force matches
+static bool checkSearch(const DFA* dfa, const char* text, size_t len, StreamMode mode, unsigned* seed) {
+    MatchList expected, found;
+    expected.count = found.count = 0;
+    bruteForce(dfa, text, len, mode, &expected);
+
+    DFAStream stream;
+    initDFAStream(&stream, dfa, mode, addMatch, &found);
+    for (size_t i = 0; i < len;) {
+        size_t chunk = 1 + nextRandom(seed) % 8;
+        if (chunk > len - i) chunk = len - i;
+        dfa_stream_feed(&stream, text + i, chunk);
+        i += chunk;
+    }
+    dfa_stream_finish(&stream);
+    freeDFAStream(&stream);
+
+    bool same = found.count == expected.count;
+    for (int i = 0; same && i < found.count && i < MAX_MATCHES; i++) {
+        same = found.start[i] == expected.start[i] && found.end[i] == expected.end[i];
+    }
+    if (!same) {
+        fprintf(stderr, "Mismatch (%s) for '%s' on '%.*s':\n",
+                mode == STREAM_EARLIEST ? "earliest" : "leftmost-longest", dfa->regex, (int)len, text);
+        printList("expected", &expected);
+        printList("found", &found);
+    }
+    return same;
+}
+
+static bool checkPattern(const char* pattern, const char* text, StreamMode mode, unsigned* seed) {
+    DFA dfa;
+    char error[256];
+    if (!compileRegex(pattern, &dfa, error, sizeof(error))) {
+        fprintf(stderr, "Error: %s\n", error);
+        return false;
+    }
+    MinimizeReport report;
+    minimizeDFA(&dfa, &report);
+    bool ok = checkSearch(&dfa, text, strlen(text), mode, seed);
+    freeDFA(&dfa);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int cases = argc > 1 ? atoi(argv[1]) : 20000;
+    unsigned seed = 12345;
+    int failures = 0;
+
+    // A run merged into one that is later dropped must not take the
+    // matches it would have found with it
+    failures += !checkPattern("ab|b+c", "abbc", STREAM_LEFTMOST_LONGEST, &seed);
+    failures += !checkPattern("x[a-z]*y|z", "xzzzz", STREAM_LEFTMOST_LONGEST, &seed);
+    failures += !checkPattern("x[a-z]*y|z", "xzzzzy", STREAM_LEFTMOST_LONGEST, &seed);
+
+    for (int c = 0; c < cases && failures < 10; c++) {
+        char pattern[128] = "";
+        randomPattern(pattern, sizeof(pattern), 1 + nextRandom(&seed) % 4, &seed);
+        char text[64];
+        size_t len = nextRandom(&seed) % sizeof(text);
+        for (size_t i = 0; i < len; i++) text[i] = "abcd"[nextRandom(&seed) % 4];
+        text[len] = '\0';
+
+        failures += !checkPattern(pattern, text, STREAM_LEFTMOST_LONGEST, &seed);
+        failures += !checkPattern(pattern, text, STREAM_EARLIEST, &seed);
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d mismatches\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("%d random patterns: stream matches agree with the brute-force scan\n", cases);
+    return 0;
+}
@@ -2,25 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
-
-#define MAX_STATES 20
-#define MAX_SYMBOLS 10
-#define MAX_TRANSITIONS 100
-
-// Structure to represent a DFA
-typedef struct {
-    int num_states;
-    int num_symbols;
-    char symbols[MAX_SYMBOLS];
-    int transition_table[MAX_STATES][MAX_SYMBOLS];
-    int start_state;
-    bool accepting_states[MAX_STATES];
-    char state_names[MAX_STATES][20];
-    char regex[100];
-} DFA;
+#include "dfa.h"
+#include "bulk.h"
+#include "batch.h"
+#include "speculative.h"
+#include "accel.h"
+#include "dfafile.h"
+#include "bench.h"
+#include "graph.h"
 
 // Initialize DFA for RE = (0|1)*01
-void initDFA_Pattern01(DFA* dfa) {
+void initDFA_Pattern01(DFA* dfa, DFAStorage* storage) {
+    attachStorage(dfa, storage);
     strcpy(dfa->regex, "(0|1)*01");
     dfa->num_states = 3;
     dfa->num_symbols = 2;
@@ -38,195 +31,318 @@ void initDFA_Pattern01(DFA* dfa) {
     dfa->accepting_states[1] = false;
     dfa->accepting_states[2] = true;
     
+    // Byte classes; adds dead state q3 for characters outside {0, 1}
+    initByteClasses(dfa);
+    
     // Transition table
     // State 0: q0
-    dfa->transition_table[0][0] = 1;  // q0 --0--> q1
-    dfa->transition_table[0][1] = 0;  // q0 --1--> q0
+    setTransition(dfa, 0, '0', 1);  // q0 --0--> q1
+    setTransition(dfa, 0, '1', 0);  // q0 --1--> q0
     
     // State 1: q1
-    dfa->transition_table[1][0] = 1;  // q1 --0--> q1
-    dfa->transition_table[1][1] = 2;  // q1 --1--> q2
+    setTransition(dfa, 1, '0', 1);  // q1 --0--> q1
+    setTransition(dfa, 1, '1', 2);  // q1 --1--> q2
     
     // State 2: q2
-    dfa->transition_table[2][0] = 1;  // q2 --0--> q1
-    dfa->transition_table[2][1] = 0;  // q2 --1--> q0
+    setTransition(dfa, 2, '0', 1);  // q2 --0--> q1
+    setTransition(dfa, 2, '1', 0);  // q2 --1--> q0
 }
 
-// Get symbol index
-int getSymbolIndex(DFA* dfa, char symbol) {
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        if (dfa->symbols[i] == symbol) {
-            return i;
-        }
+// Validate a newline-delimited file without per-string output
+int runBulkMode(DFA* dfa, const char* input_path, const char* bitmap_path, int num_threads) {
+    MappedFile file;
+    if (!mapFile(input_path, &file)) {
+        return EXIT_FAILURE;
     }
-    return -1;
-}
 
-// Validate string with step-by-step output
-bool validateString(DFA* dfa, const char* str) {
-    int current_state = dfa->start_state;
-    
-    printf("\n  Initial state: %s\n", dfa->state_names[current_state]);
-    printf("  Transitions:\n");
-    
-    for (int i = 0; str[i] != '\0'; i++) {
-        int symbol_idx = getSymbolIndex(dfa, str[i]);
-        if (symbol_idx == -1) {
-            printf("  Invalid character '%c' in input\n", str[i]);
-            return false;
-        }
-        
-        int next_state = dfa->transition_table[current_state][symbol_idx];
-        printf("    %s --(%c)--> %s", 
-               dfa->state_names[current_state], 
-               str[i], 
-               dfa->state_names[next_state]);
-        
-        if (dfa->accepting_states[next_state]) {
-            printf(" [accepting]");
+    unsigned char* bitmap = NULL;
+    if (bitmap_path) {
+        bitmap = calloc(bitmapSize(file.size), 1);
+        if (!bitmap) {
+            perror("Error allocating bitmap");
+            unmapFile(&file);
+            return EXIT_FAILURE;
         }
-        printf("\n");
-        
-        current_state = next_state;
     }
-    
-    printf("  Final state: %s\n", dfa->state_names[current_state]);
-    bool accepted = dfa->accepting_states[current_state];
-    printf("  Result: %s\n", accepted ? "ACCEPTED" : "REJECTED");
-    
-    return accepted;
-}
 
-// Generate Graphviz DOT file
-void generateDotFile(DFA* dfa, const char* filename) {
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        perror("Error creating DOT file");
-        exit(EXIT_FAILURE);
+    BulkResult result;
+    double start = wallClockSeconds();
+    if (num_threads > 1) {
+        validateLinesParallel(dfa, file.data, file.size, num_threads, bitmap, &result);
+    } else {
+        validateLines(dfa, file.data, file.size, bitmap, &result);
     }
-    
-    fprintf(file, "digraph DFA {\n");
-    fprintf(file, "    rankdir=LR;\n");
-    fprintf(file, "    graph [pad=\"0.5\", nodesep=\"1.2\", ranksep=\"2.0\", bgcolor=\"white\"];\n");
-    fprintf(file, "    node [fontname=\"Arial\", fontsize=14, style=filled, fillcolor=\"lightblue\"];\n");
-    fprintf(file, "    edge [fontname=\"Arial\", fontsize=12, arrowsize=0.8];\n");
-    fprintf(file, "    labelloc=\"t\";\n");
-    fprintf(file, "    label=\"DFA for Regular Expression: %s\";\n", dfa->regex);
-    fprintf(file, "    fontsize=18;\n");
-    fprintf(file, "    fontname=\"Arial Bold\";\n\n");
-    
-    // Initial arrow
-    fprintf(file, "    node [shape=point, width=0]; start;\n");
-    fprintf(file, "    start -> %s [label=\"start\"];\n\n", dfa->state_names[dfa->start_state]);
-    
-    // Define all states
-    for (int i = 0; i < dfa->num_states; i++) {
-        if (dfa->accepting_states[i]) {
-            fprintf(file, "    %s [shape=doublecircle, fixedsize=true, width=1.0, fillcolor=\"lightgreen\"];\n", 
-                    dfa->state_names[i]);
+    double elapsed = wallClockSeconds() - start;
+
+    printf("========================================\n");
+    printf("Bulk Validation: %s\n", dfa->regex);
+    printf("========================================\n");
+    printf("Input file: %s (%zu bytes)\n", input_path, file.size);
+    printf("Threads:    %d\n", num_threads);
+    printf("Strings:    %zu\n", result.lines);
+    printf("Accepted:   %zu\n", result.accepted);
+    printf("Rejected:   %zu\n", result.rejected);
+    printf("Time:       %.6f s (%.1f MB/s)\n", elapsed,
+           elapsed > 0 ? file.size / elapsed / 1e6 : 0.0);
+
+    int status = 0;
+    if (bitmap) {
+        FILE* out = fopen(bitmap_path, "wb");
+        size_t bytes = (result.lines + 7) / 8;
+        if (!out || fwrite(bitmap, 1, bytes, out) != bytes) {
+            perror("Error writing bitmap");
+            status = EXIT_FAILURE;
         } else {
-            fprintf(file, "    %s [shape=circle, fixedsize=true, width=1.0];\n", 
-                    dfa->state_names[i]);
+            printf("Bitmap:     %s (%zu bytes, bit i set = line i accepted)\n", bitmap_path, bytes);
         }
+        if (out) fclose(out);
+        free(bitmap);
     }
-    fprintf(file, "\n");
-    
-    // Add transitions
-    for (int i = 0; i < dfa->num_states; i++) {
-        for (int j = 0; j < dfa->num_symbols; j++) {
-            int next_state = dfa->transition_table[i][j];
-            
-            // Check if this is a self-loop
-            if (i == next_state) {
-                fprintf(file, "    %s -> %s [label=\"%c\", style=bold];\n",
-                        dfa->state_names[i],
-                        dfa->state_names[next_state],
-                        dfa->symbols[j]);
-            } else {
-                fprintf(file, "    %s -> %s [label=\"%c\"];\n",
-                        dfa->state_names[i],
-                        dfa->state_names[next_state],
-                        dfa->symbols[j]);
-            }
+
+    unmapFile(&file);
+    return status;
+}
+
+// Time bulk validation of a file with 1..max_threads threads
+int runScalingMode(DFA* dfa, const char* input_path, int max_threads) {
+    MappedFile file;
+    if (!mapFile(input_path, &file)) {
+        return EXIT_FAILURE;
+    }
+
+    printf("========================================\n");
+    printf("Thread Scaling: %s\n", dfa->regex);
+    printf("========================================\n");
+    printf("Input file: %s (%zu bytes), %d CPUs, best of 3 runs\n\n",
+           input_path, file.size, cpuCount());
+    printf("  Threads      Time (s)      MB/s   Speedup\n");
+    printf("  -------    ----------   -------   -------\n");
+
+    BulkResult baseline = {0, 0, 0};
+    double baseline_time = 0;
+    int status = 0;
+    for (int t = 1; t <= max_threads; t++) {
+        BulkResult result;
+        double best = 1e30;
+        for (int run = 0; run < 3; run++) {
+            double start = wallClockSeconds();
+            validateLinesParallel(dfa, file.data, file.size, t, NULL, &result);
+            double elapsed = wallClockSeconds() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        if (t == 1) {
+            baseline = result;
+            baseline_time = best;
+        } else if (result.accepted != baseline.accepted || result.lines != baseline.lines) {
+            fprintf(stderr, "✗ Error: %d threads disagree with 1 thread\n", t);
+            status = EXIT_FAILURE;
         }
+        printf("  %7d    %10.6f   %7.1f   %6.2fx\n", t, best,
+               best > 0 ? file.size / best / 1e6 : 0.0,
+               best > 0 ? baseline_time / best : 0.0);
     }
-    
-    fprintf(file, "}\n");
-    fclose(file);
+    printf("\nStrings: %zu, Accepted: %zu, Rejected: %zu\n",
+           baseline.lines, baseline.accepted, baseline.rejected);
+
+    unmapFile(&file);
+    return status;
 }
 
-// Print transition table
-void printTransitionTable(DFA* dfa) {
-    printf("Transition Table:\n");
-    printf("  +-------+");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("-------+");
+// Validate a whole file as one string, sequentially and speculatively
+int runSpeculativeMode(DFA* dfa, const char* input_path, int num_threads) {
+    MappedFile file;
+    if (!mapFile(input_path, &file)) {
+        return EXIT_FAILURE;
     }
-    printf("\n");
-    
-    printf("  | State |");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("   %c   |", dfa->symbols[i]);
+
+    printf("========================================\n");
+    printf("Speculative Validation: %s\n", dfa->regex);
+    printf("========================================\n");
+    printf("Input file: %s (%zu bytes, one string)\n", input_path, file.size);
+    printf("Kernel:     %s (%d states)\n", speculativeKernel(dfa), dfa->num_states);
+    printf("Best of 3 runs\n\n");
+
+    double best_sequential = 1e30, best_speculative = 1e30;
+    int sequential_state = 0, speculative_state = 0;
+    for (int run = 0; run < 3; run++) {
+        double start = wallClockSeconds();
+        sequential_state = dfa_run(dfa, dfa->start_state, file.data, file.size);
+        double middle = wallClockSeconds();
+        speculative_state = runSpeculative(dfa, file.data, file.size, num_threads);
+        double end = wallClockSeconds();
+        if (middle - start < best_sequential) best_sequential = middle - start;
+        if (end - middle < best_speculative) best_speculative = end - middle;
     }
-    printf("\n");
-    
-    printf("  +-------+");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("-------+");
+
+    printf("  Sequential:            %10.6f s  %8.1f MB/s\n", best_sequential,
+           best_sequential > 0 ? file.size / best_sequential / 1e6 : 0.0);
+    printf("  Speculative (%2d thr):  %10.6f s  %8.1f MB/s  %6.2fx\n", num_threads, best_speculative,
+           best_speculative > 0 ? file.size / best_speculative / 1e6 : 0.0,
+           best_speculative > 0 ? best_sequential / best_speculative : 0.0);
+    printf("\nFinal state: %s -> %s\n", dfa->state_names[speculative_state],
+           dfa->accepting_states[speculative_state] ? "ACCEPTED" : "REJECTED");
+
+    int status = 0;
+    if (sequential_state != speculative_state) {
+        fprintf(stderr, "✗ Error: speculative run ended in %s, sequential in %s\n",
+                dfa->state_names[speculative_state], dfa->state_names[sequential_state]);
+        status = EXIT_FAILURE;
     }
-    printf("\n");
-    
-    for (int i = 0; i < dfa->num_states; i++) {
-        if (dfa->accepting_states[i]) {
-            printf("  | *%-4s |", dfa->state_names[i]);
-        } else {
-            printf("  |  %-4s |", dfa->state_names[i]);
-        }
-        
-        for (int j = 0; j < dfa->num_symbols; j++) {
-            int next = dfa->transition_table[i][j];
-            if (dfa->accepting_states[next]) {
-                printf(" *%-4s|", dfa->state_names[next]);
+
+    unmapFile(&file);
+    return status;
+}
+
+// Validate a whole file as one string, with and without accelerated states
+int runAccelMode(DFA* dfa, const char* input_path) {
+    MappedFile file;
+    if (!mapFile(input_path, &file)) {
+        return EXIT_FAILURE;
+    }
+
+    AccelDFA accel;
+    initAccelDFA(&accel, dfa);
+
+    printf("========================================\n");
+    printf("Accelerated Validation: %s\n", dfa->regex);
+    printf("========================================\n");
+    printf("Input file: %s (%zu bytes, one string)\n", input_path, file.size);
+    printf("Kernel:     %s\n", accelKernel(&accel));
+    printf("Accelerated states (%d of %d):\n", accel.num_accelerated, dfa->num_states);
+    for (int s = 0; s < dfa->num_states; s++) {
+        int index = accel.scan_index[s];
+        if (index < 0) continue;
+        const AccelScan* scan = &accel.scans[index];
+        printf("  %-6s scan for bytes %s", dfa->state_names[s], scan->ranges_loop ? "outside" : "in");
+        if (scan->num_ranges == 0) printf(" (none)");
+        for (int r = 0; r < scan->num_ranges; r++) {
+            printf(r == 0 ? " " : ", ");
+            if (scan->lo[r] == scan->hi[r]) {
+                printf("0x%02x", scan->lo[r]);
             } else {
-                printf("  %-4s|", dfa->state_names[next]);
+                printf("0x%02x-0x%02x", scan->lo[r], scan->hi[r]);
             }
         }
         printf("\n");
     }
-    
-    printf("  +-------+");
-    for (int i = 0; i < dfa->num_symbols; i++) {
-        printf("-------+");
+    printf("Best of 3 runs\n\n");
+
+    double best_plain = 1e30, best_accel = 1e30;
+    int plain_state = 0, accel_state = 0;
+    size_t skipped = 0;
+    for (int run = 0; run < 3; run++) {
+        skipped = 0;
+        double start = wallClockSeconds();
+        plain_state = dfa_run(dfa, dfa->start_state, file.data, file.size);
+        double middle = wallClockSeconds();
+        accel_state = accel_run(&accel, dfa->start_state, file.data, file.size, &skipped);
+        double end = wallClockSeconds();
+        if (middle - start < best_plain) best_plain = middle - start;
+        if (end - middle < best_accel) best_accel = end - middle;
     }
-    printf("\n");
-    printf("  (* denotes accepting state)\n\n");
+
+    printf("  Table steps:  %10.6f s  %8.1f MB/s\n", best_plain,
+           best_plain > 0 ? file.size / best_plain / 1e6 : 0.0);
+    printf("  Accelerated:  %10.6f s  %8.1f MB/s  %6.2fx\n", best_accel,
+           best_accel > 0 ? file.size / best_accel / 1e6 : 0.0,
+           best_accel > 0 ? best_plain / best_accel : 0.0);
+    printf("  Bytes skipped: %zu of %zu (%.1f%%)\n", skipped, file.size,
+           file.size > 0 ? 100.0 * skipped / file.size : 0.0);
+    printf("\nFinal state: %s -> %s\n", dfa->state_names[accel_state],
+           dfa->accepting_states[accel_state] ? "ACCEPTED" : "REJECTED");
+
+    int status = 0;
+    if (plain_state != accel_state) {
+        fprintf(stderr, "✗ Error: accelerated run ended in %s, table steps in %s\n",
+                dfa->state_names[accel_state], dfa->state_names[plain_state]);
+        status = EXIT_FAILURE;
+    }
+
+    freeAccelDFA(&accel);
+    unmapFile(&file);
+    return status;
 }
 
-int main() {
-    DFA dfa;
-    initDFA_Pattern01(&dfa);
+int printUsage(const char* program) {
+    fprintf(stderr, "Usage: %s [string...]\n", program);
+    fprintf(stderr, "       %s --bulk <input-file> [--bitmap <output-file>] [--threads N]\n", program);
+    fprintf(stderr, "       %s --scaling <input-file> [max-threads]\n", program);
+    fprintf(stderr, "       %s --speculative <input-file> [threads]\n", program);
+    fprintf(stderr, "       %s --accel <input-file>\n", program);
+    fprintf(stderr, "       %s --bench [max-megabytes] [threads]\n", program);
+    fprintf(stderr, "Any mode may be preceded by --dfa <file.dfa> to load a compiled DFA\n");
+    return EXIT_FAILURE;
+}
+
+// Run the mode selected by argv (the traced demo on the given strings,
+// or on the built-in test strings, when no mode is named)
+int runCommand(DFA* dfa, int argc, char* argv[]) {
+    if (argc > 1 && argv[1][0] == '-') {
+        if (strcmp(argv[1], "--bulk") == 0 && argc >= 3) {
+            const char* bitmap_path = NULL;
+            int num_threads = cpuCount();
+            for (int i = 3; i < argc; i += 2) {
+                if (i + 1 >= argc) return printUsage(argv[0]);
+                if (strcmp(argv[i], "--bitmap") == 0) {
+                    bitmap_path = argv[i + 1];
+                } else if (strcmp(argv[i], "--threads") == 0 && atoi(argv[i + 1]) > 0) {
+                    num_threads = atoi(argv[i + 1]);
+                } else {
+                    return printUsage(argv[0]);
+                }
+            }
+            return runBulkMode(dfa, argv[2], bitmap_path, num_threads);
+        }
+        if (strcmp(argv[1], "--scaling") == 0 && (argc == 3 || argc == 4)) {
+            int max_threads = argc == 4 ? atoi(argv[3]) : cpuCount();
+            return runScalingMode(dfa, argv[2], max_threads > 0 ? max_threads : 1);
+        }
+        if (strcmp(argv[1], "--speculative") == 0 && (argc == 3 || argc == 4)) {
+            int num_threads = argc == 4 ? atoi(argv[3]) : cpuCount();
+            return runSpeculativeMode(dfa, argv[2], num_threads > 0 ? num_threads : 1);
+        }
+        if (strcmp(argv[1], "--accel") == 0 && argc == 3) {
+            return runAccelMode(dfa, argv[2]);
+        }
+        if (strcmp(argv[1], "--bench") == 0 && argc <= 4) {
+            long max_mb = argc >= 3 ? atol(argv[2]) : 32;
+            int num_threads = argc == 4 ? atoi(argv[3]) : cpuCount();
+            if (max_mb < 1) return printUsage(argv[0]);
+            runBenchmarkSuite(dfa, (size_t)max_mb << 20, num_threads > 0 ? num_threads : 1, stdout);
+            return EXIT_SUCCESS;
+        }
+        return printUsage(argv[0]);
+    }
     
-    const char* test_strings[] = {"1101", "111", "0001"};
-    int num_tests = sizeof(test_strings) / sizeof(test_strings[0]);
+    const char* default_strings[] = {"1101", "111", "0001"};
+    const char** test_strings = default_strings;
+    int num_tests = sizeof(default_strings) / sizeof(default_strings[0]);
+    if (argc > 1) {
+        test_strings = (const char**)(argv + 1);
+        num_tests = argc - 1;
+    }
     
     printf("========================================\n");
-    printf("DFA for Regular Expression: %s\n", dfa.regex);
+    printf("DFA for Regular Expression: %s\n", dfa->regex);
     printf("========================================\n");
     
     printf("\nDFA States:\n");
-    for (int i = 0; i < dfa.num_states; i++) {
-        printf("  %s: ", dfa.state_names[i]);
-        if (i == dfa.start_state) {
+    for (int i = 0; i < dfa->num_states; i++) {
+        printf("  %s: ", dfa->state_names[i]);
+        if (i == dfa->start_state) {
             printf("Initial state");
         }
-        if (dfa.accepting_states[i]) {
+        if (dfa->accepting_states[i]) {
             printf(" (Accepting)");
         }
+        if (i == dfa->dead_state) {
+            printf("Dead state");
+        }
         printf("\n");
     }
     printf("\n");
     
-    printTransitionTable(&dfa);
+    printTransitionTable(dfa);
     
     printf("========================================\n");
     printf("Testing Strings\n");
@@ -237,7 +353,7 @@ int main() {
         const char* str = test_strings[i];
         printf("\n[Test %d] String: '%s'\n", i+1, str);
         printf("----------------------------------------\n");
-        results[i] = validateString(&dfa, str);
+        results[i] = validateString(dfa, str);
     }
     
     printf("\n========================================\n");
@@ -253,22 +369,14 @@ int main() {
     printf("Generating Visualization\n");
     printf("========================================\n");
     const char* dot_filename = "dfa.dot";
-    generateDotFile(&dfa, dot_filename);
+    generateDotFile(dfa, dot_filename);
     printf("DFA visualization file '%s' created.\n", dot_filename);
     
-    // Convert DOT file to PNG using Graphviz
-    printf("Converting DOT file to PNG...\n");
-    char command[256];
-    snprintf(command, sizeof(command), "dot -Tpng %s -o output.png -Gdpi=300", dot_filename);
-    int result = system(command);
-    
-    if (result == 0) {
-        printf("✓ DFA visualization saved as 'output.png'\n");
-    } else {
-        printf("✗ Error: Could not generate PNG.\n");
-        printf("  Make sure Graphviz is installed and 'dot' is in your PATH.\n");
-        printf("  Manual conversion: dot -Tpng %s -o output.png\n", dot_filename);
-    }
+    // Draw the diagram in process (no Graphviz needed)
+    const char* svg_filename = "dfa.svg";
+    generateSvgFile(dfa, svg_filename);
+    printf("✓ DFA visualization saved as '%s'\n", svg_filename);
+    printf("  For a Graphviz rendering: dot -Tpng %s -o output.png\n", dot_filename);
     
     printf("\n========================================\n");
     printf("Done!\n");
@@ -276,3 +384,25 @@ int main() {
     
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    DFA dfa;
+    DFAStorage storage;
+    MappedFile dfa_file = { NULL, 0, NULL };
+
+    // --dfa <file>: use a compiled DFA instead of the built-in one
+    if (argc > 2 && strcmp(argv[1], "--dfa") == 0) {
+        if (!loadDFA(argv[2], &dfa, &dfa_file)) {
+            return EXIT_FAILURE;
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    } else {
+        initDFA_Pattern01(&dfa, &storage);
+    }
+
+    int status = runCommand(&dfa, argc, argv);
+    unmapFile(&dfa_file);
+    return status;
+}
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "accel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_SIMD_SCAN 1
+#endif
+
+// Every visit to an accelerated state earns the bytes it skipped minus
+// VISIT_COST. When the balance falls to -MAX_CREDIT, some bytes are
+// stepped without scanning: MIN_BACKOFF at first, doubling up to
+// MAX_BACKOFF until the balance reaches +MAX_CREDIT again
+#define VISIT_COST 8
+#define MAX_CREDIT 64
+#define MIN_BACKOFF 256
+#define MAX_BACKOFF 65536
+
+enum { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+
+static const char* kernel_names[] = { "scalar", "SSE2", "AVX2" };
+
+// Count the byte ranges whose escapes[] entries differ from ranges_loop
+// and, if there are at most MAX_ACCEL_RANGES, store them in scan
+static int collectRanges(AccelScan* scan, bool ranges_loop, bool store) {
+    int count = 0;
+    for (int b = 0; b < 256; b++) {
+        if (scan->escapes[b] == ranges_loop) continue;
+        int lo = b;
+        while (b + 1 < 256 && scan->escapes[b + 1] != ranges_loop) b++;
+        if (store && count < MAX_ACCEL_RANGES) {
+            scan->lo[count] = (unsigned char)lo;
+            scan->hi[count] = (unsigned char)b;
+        }
+        count++;
+    }
+    return count;
+}
+
+// Find the accelerated states of dfa
+void initAccelDFA(AccelDFA* accel, const DFA* dfa) {
+    int n = dfa->num_states;
+    accel->dfa = dfa;
+    accel->num_accelerated = 0;
+    accel->scan_index = malloc((size_t)n * sizeof(int));
+    accel->scans = malloc((size_t)n * sizeof(AccelScan));
+    if (!accel->scan_index || !accel->scans) {
+        perror("Error allocating accelerated states");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int s = 0; s < n; s++) {
+        accel->scan_index[s] = -1;
+        int escape_classes = 0;
+        for (int c = 0; c < dfa->num_classes; c++) {
+            if (dfa_next(dfa, s, c) != s) escape_classes++;
+        }
+        if (escape_classes == dfa->num_classes || escape_classes > MAX_ACCEL_ESCAPES) continue;
+
+        AccelScan* scan = &accel->scans[accel->num_accelerated];
+        for (int b = 0; b < 256; b++) {
+            scan->escapes[b] = dfa_next(dfa, s, dfa->class_map[b]) != s;
+        }
+        // Describe whichever side takes fewer ranges (the dead state has
+        // no escapes at all, so its scans always run to the end)
+        int escape_ranges = collectRanges(scan, false, false);
+        int loop_ranges = collectRanges(scan, true, false);
+        scan->ranges_loop = loop_ranges < escape_ranges;
+        scan->num_ranges = scan->ranges_loop ? loop_ranges : escape_ranges;
+        if (scan->num_ranges > MAX_ACCEL_RANGES) continue;
+        collectRanges(scan, scan->ranges_loop, true);
+        accel->scan_index[s] = accel->num_accelerated++;
+    }
+
+    accel->kernel = KERNEL_SCALAR;
+#ifdef HAVE_SIMD_SCAN
+    if (__builtin_cpu_supports("avx2")) {
+        accel->kernel = KERNEL_AVX2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        accel->kernel = KERNEL_SSE2;
+    }
+#endif
+}
+
+// Release memory owned by accel
+void freeAccelDFA(AccelDFA* accel) {
+    free(accel->scan_index);
+    free(accel->scans);
+    accel->scan_index = NULL;
+    accel->scans = NULL;
+    accel->num_accelerated = 0;
+}
+
+// Name of the scan kernel
+const char* accelKernel(const AccelDFA* accel) {
+    return kernel_names[accel->kernel];
+}
+
+// Scalar scan: offset of the first escaping byte, or len. A single
+// escape byte is left to memchr, which the C library vectorises itself.
+static size_t scanScalar(const AccelScan* scan, const unsigned char* p, size_t len) {
+    if (scan->num_ranges == 1 && !scan->ranges_loop && scan->lo[0] == scan->hi[0]) {
+        const unsigned char* hit = memchr(p, scan->lo[0], len);
+        return hit ? (size_t)(hit - p) : len;
+    }
+    size_t i = 0;
+    while (i < len && !scan->escapes[p[i]]) i++;
+    return i;
+}
+
+#ifdef HAVE_SIMD_SCAN
+// SSE2 scan, 16 bytes per step. A byte v is in [lo, hi] exactly when
+// the wrapping difference v - lo saturates to 0 after subtracting hi - lo.
+__attribute__((target("sse2")))
+static size_t scanSse2(const AccelScan* scan, const unsigned char* p, size_t len) {
+    __m128i lo[MAX_ACCEL_RANGES], width[MAX_ACCEL_RANGES];
+    for (int r = 0; r < scan->num_ranges; r++) {
+        lo[r] = _mm_set1_epi8((char)scan->lo[r]);
+        width[r] = _mm_set1_epi8((char)(scan->hi[r] - scan->lo[r]));
+    }
+    const __m128i zero = _mm_setzero_si128();
+    unsigned flip = scan->ranges_loop ? 0xFFFFu : 0;
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i in = zero;
+        for (int r = 0; r < scan->num_ranges; r++) {
+            __m128i over = _mm_subs_epu8(_mm_sub_epi8(v, lo[r]), width[r]);
+            in = _mm_or_si128(in, _mm_cmpeq_epi8(over, zero));
+        }
+        unsigned mask = (unsigned)_mm_movemask_epi8(in) ^ flip;
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scanScalar(scan, p + i, len - i);
+}
+
+// AVX2 scan, 32 bytes per step, same range test as scanSse2
+__attribute__((target("avx2")))
+static size_t scanAvx2(const AccelScan* scan, const unsigned char* p, size_t len) {
+    __m256i lo[MAX_ACCEL_RANGES], width[MAX_ACCEL_RANGES];
+    for (int r = 0; r < scan->num_ranges; r++) {
+        lo[r] = _mm256_set1_epi8((char)scan->lo[r]);
+        width[r] = _mm256_set1_epi8((char)(scan->hi[r] - scan->lo[r]));
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned flip = scan->ranges_loop ? 0xFFFFFFFFu : 0;
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i in = zero;
+        for (int r = 0; r < scan->num_ranges; r++) {
+            __m256i over = _mm256_subs_epu8(_mm256_sub_epi8(v, lo[r]), width[r]);
+            in = _mm256_or_si256(in, _mm256_cmpeq_epi8(over, zero));
+        }
+        unsigned mask = (unsigned)_mm256_movemask_epi8(in) ^ flip;
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scanSse2(scan, p + i, len - i);
+}
+#endif
+
+// Offset of the first byte in p[0..len) that leaves the scan's state
+static size_t scanEscape(const AccelDFA* accel, const AccelScan* scan, const unsigned char* p, size_t len) {
+#ifdef HAVE_SIMD_SCAN
+    if (accel->kernel == KERNEL_AVX2) return scanAvx2(scan, p, len);
+    if (accel->kernel == KERNEL_SSE2) return scanSse2(scan, p, len);
+#endif
+    (void)accel;
+    return scanScalar(scan, p, len);
+}
+
+// Per-width step loops like dfa_run8/16/32. In an accelerated state the
+// next byte is checked first, so a run that leaves straight away costs
+// one extra lookup rather than a whole scan. When visits keep skipping
+// little or nothing, the input leaves its self-loops too often for
+// scanning to pay off, so the next stretch is stepped through the table
+// without looking for accelerated states.
+#define DEFINE_ACCEL_RUN(name, type)                                                     \
+    static int name(const AccelDFA* accel, int state, const unsigned char* p, size_t len, \
+                    size_t* skipped) {                                                   \
+        const type* table = accel->dfa->transition_table;                                \
+        const unsigned char* class_map = accel->dfa->class_map;                          \
+        const int* scan_index = accel->scan_index;                                       \
+        int num_classes = accel->dfa->num_classes;                                       \
+        size_t i = 0, skip = 0;                                                          \
+        long credit = 0;                                                                 \
+        size_t backoff = MIN_BACKOFF;                                                    \
+        while (i < len) {                                                                \
+            int index = scan_index[state];                                               \
+            if (index >= 0) {                                                            \
+                const AccelScan* scan = &accel->scans[index];                            \
+                size_t n = scan->escapes[p[i]] ? 0                                       \
+                         : 1 + scanEscape(accel, scan, p + i + 1, len - i - 1);          \
+                i += n;                                                                  \
+                skip += n;                                                               \
+                credit += (long)n - VISIT_COST;                                          \
+                if (credit >= MAX_CREDIT) {                                              \
+                    credit = MAX_CREDIT;                                                 \
+                    backoff = MIN_BACKOFF;                                               \
+                } else if (credit <= -MAX_CREDIT) {                                      \
+                    credit = 0;                                                          \
+                    size_t end = len - i < backoff ? len : i + backoff;                  \
+                    if (backoff < MAX_BACKOFF) backoff *= 2;                             \
+                    for (; i < end; i++) {                                               \
+                        state = table[state * num_classes + class_map[p[i]]];            \
+                    }                                                                    \
+                    continue;                                                            \
+                }                                                                        \
+                if (i == len) break;                                                     \
+            }                                                                            \
+            state = table[state * num_classes + class_map[p[i]]];                        \
+            i++;                                                                         \
+        }                                                                                \
+        *skipped += skip;                                                                \
+        return state;                                                                    \
+    }
+
+DEFINE_ACCEL_RUN(accelRun8, uint8_t)
+DEFINE_ACCEL_RUN(accelRun16, uint16_t)
+DEFINE_ACCEL_RUN(accelRun32, int32_t)
+
+// Run len bytes from state, scanning ahead in accelerated states
+int accel_run(const AccelDFA* accel, int state, const char* str, size_t len, size_t* skipped) {
+    size_t ignored = 0;
+    if (!skipped) skipped = &ignored;
+    if (accel->num_accelerated == 0) {
+        return dfa_run(accel->dfa, state, str, len);
+    }
+    const unsigned char* p = (const unsigned char*)str;
+    switch (accel->dfa->table_width) {
+        case 1: return accelRun8(accel, state, p, len, skipped);
+        case 2: return accelRun16(accel, state, p, len, skipped);
+        default: return accelRun32(accel, state, p, len, skipped);
+    }
+}
+
+// Whole-input acceptance test
+bool accel_accepts(const AccelDFA* accel, const char* str, size_t len, size_t* skipped) {
+    return accel->dfa->accepting_states[accel_run(accel, accel->dfa->start_state, str, len, skipped)];
+}
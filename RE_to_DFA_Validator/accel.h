@@ -0,0 +1,50 @@
+#ifndef ACCEL_H
+#define ACCEL_H
+
+#include <stddef.h>
+#include "dfa.h"
+
+// A state is accelerated when it loops back to itself on every byte
+// class but at most MAX_ACCEL_ESCAPES, and either the bytes that leave
+// it or the bytes that keep it are at most MAX_ACCEL_RANGES byte ranges
+#define MAX_ACCEL_ESCAPES 3
+#define MAX_ACCEL_RANGES 3
+
+// How to find the next byte that leaves an accelerated state
+typedef struct {
+    int num_ranges;
+    bool ranges_loop;                     // ranges hold the self-loop bytes, not the escapes
+    unsigned char lo[MAX_ACCEL_RANGES];
+    unsigned char hi[MAX_ACCEL_RANGES];
+    bool escapes[256];                    // scalar check and tail handling
+} AccelScan;
+
+// Run-time acceleration data for a DFA. While the run is in an
+// accelerated state, whole blocks of bytes are tested at once (SSE2 or
+// AVX2 range compares, a scalar byte test elsewhere) to jump straight to
+// the next escaping byte instead of stepping the table for every byte.
+typedef struct {
+    const DFA* dfa;
+    int num_accelerated;
+    int* scan_index;                      // per state: index into scans, -1 if not accelerated
+    AccelScan* scans;
+    int kernel;
+} AccelDFA;
+
+// Find the accelerated states of dfa (which must outlive accel)
+void initAccelDFA(AccelDFA* accel, const DFA* dfa);
+
+// Release memory owned by accel
+void freeAccelDFA(AccelDFA* accel);
+
+// Same result as dfa_run. If skipped is not NULL, the number of bytes
+// passed over by scans instead of table steps is added to it.
+int accel_run(const AccelDFA* accel, int state, const char* str, size_t len, size_t* skipped);
+
+// Whole-input acceptance test built on accel_run
+bool accel_accepts(const AccelDFA* accel, const char* str, size_t len, size_t* skipped);
+
+// Name of the scan kernel accel_run uses
+const char* accelKernel(const AccelDFA* accel);
+
+#endif
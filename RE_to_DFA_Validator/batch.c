@@ -0,0 +1,173 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "batch.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Chunks per thread; more chunks than threads evens out uneven lines
+#define CHUNKS_PER_THREAD 4
+#define MIN_CHUNK_BYTES (64 * 1024)
+
+typedef struct {
+    const char* start;
+    size_t size;
+    unsigned char* bitmap;
+    BulkResult result;
+} Chunk;
+
+typedef struct {
+    void (*task)(void* ctx, int index);
+    void* ctx;
+    int num_tasks;
+    int next_task;
+    pthread_mutex_t lock;
+} TaskQueue;
+
+typedef struct {
+    const DFA* dfa;
+    Chunk* chunks;
+} BatchJob;
+
+// Number of online CPUs
+int cpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+// Worker: claim tasks until none are left
+static void* taskWorker(void* arg) {
+    TaskQueue* queue = arg;
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next_task++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->num_tasks) break;
+
+        queue->task(queue->ctx, index);
+    }
+    return NULL;
+}
+
+// Run task(ctx, i) for every i on a pool of threads
+void parallelFor(int num_tasks, int num_threads, void (*task)(void* ctx, int index), void* ctx) {
+    TaskQueue queue = { task, ctx, num_tasks, 0, PTHREAD_MUTEX_INITIALIZER };
+    if (num_threads > num_tasks) num_threads = num_tasks;
+    if (num_threads < 1) num_threads = 1;
+
+    pthread_t* threads = malloc((size_t)num_threads * sizeof(pthread_t));
+    if (!threads) {
+        perror("Error allocating threads");
+        exit(EXIT_FAILURE);
+    }
+    int started = 0;
+    for (int t = 1; t < num_threads; t++) {
+        if (pthread_create(&threads[t], NULL, taskWorker, &queue) != 0) break;
+        started = t;
+    }
+    taskWorker(&queue);  // the calling thread works too
+    for (int t = 1; t <= started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+}
+
+// Validate one chunk of lines
+static void validateChunk(void* ctx, int index) {
+    BatchJob* job = ctx;
+    Chunk* chunk = &job->chunks[index];
+    validateLines(job->dfa, chunk->start, chunk->size, chunk->bitmap, &chunk->result);
+}
+
+// Copy nbits bits from src (starting at bit 0) into dst starting at dst_bit
+static void appendBits(unsigned char* dst, size_t dst_bit, const unsigned char* src, size_t nbits) {
+    size_t shift = dst_bit & 7;
+    unsigned char* out = dst + (dst_bit >> 3);
+    size_t nbytes = (nbits + 7) / 8;
+
+    if (shift == 0) {
+        memcpy(out, src, nbytes);
+        return;
+    }
+    for (size_t i = 0; i < nbytes; i++) {
+        out[i] |= (unsigned char)(src[i] << shift);
+        if ((i * 8) + (8 - shift) < nbits) {
+            out[i + 1] |= (unsigned char)(src[i] >> (8 - shift));
+        }
+    }
+}
+
+// Multi-threaded validateLines
+void validateLinesParallel(const DFA* dfa, const char* data, size_t size, int num_threads,
+                           unsigned char* bitmap, BulkResult* result) {
+    if (num_threads < 1) num_threads = 1;
+
+    // Split into line-aligned chunks: each boundary moves past the next '\n'
+    int max_chunks = num_threads * CHUNKS_PER_THREAD;
+    if ((size_t)max_chunks > size / MIN_CHUNK_BYTES) max_chunks = (int)(size / MIN_CHUNK_BYTES);
+    if (max_chunks < 1) max_chunks = 1;
+
+    Chunk* chunks = calloc((size_t)max_chunks, sizeof(Chunk));
+    if (!chunks) {
+        perror("Error allocating batch chunks");
+        exit(EXIT_FAILURE);
+    }
+
+    int num_chunks = 0;
+    size_t offset = 0;
+    while (offset < size && num_chunks < max_chunks) {
+        size_t end = (num_chunks == max_chunks - 1) ? size : offset + size / max_chunks;
+        if (end >= size) {
+            end = size;
+        } else {
+            const char* newline = memchr(data + end, '\n', size - end);
+            end = newline ? (size_t)(newline - data) + 1 : size;
+        }
+        chunks[num_chunks].start = data + offset;
+        chunks[num_chunks].size = end - offset;
+        if (bitmap) {
+            chunks[num_chunks].bitmap = calloc(bitmapSize(end - offset), 1);
+            if (!chunks[num_chunks].bitmap) {
+                perror("Error allocating batch bitmap");
+                exit(EXIT_FAILURE);
+            }
+        }
+        num_chunks++;
+        offset = end;
+    }
+
+    BatchJob job = { dfa, chunks };
+    parallelFor(num_chunks, num_threads, validateChunk, &job);
+
+    // Merge in input order
+    result->lines = 0;
+    result->accepted = 0;
+    result->rejected = 0;
+    for (int c = 0; c < num_chunks; c++) {
+        if (bitmap) {
+            appendBits(bitmap, result->lines, chunks[c].bitmap, chunks[c].result.lines);
+            free(chunks[c].bitmap);
+        }
+        result->lines += chunks[c].result.lines;
+        result->accepted += chunks[c].result.accepted;
+        result->rejected += chunks[c].result.rejected;
+    }
+
+    free(chunks);
+}
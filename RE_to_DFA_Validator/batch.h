@@ -0,0 +1,20 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "bulk.h"
+
+// Number of online CPUs (at least 1)
+int cpuCount(void);
+
+// Run task(ctx, i) for i in [0, num_tasks) on up to num_threads threads
+// (the calling thread included); returns when every task has finished
+void parallelFor(int num_tasks, int num_threads, void (*task)(void* ctx, int index), void* ctx);
+
+// Multi-threaded validateLines: the input is split into line-aligned
+// chunks that num_threads workers validate against the shared read-only
+// DFA. Per-chunk results are merged in input order, so result and bitmap
+// are identical to the single-threaded validateLines.
+void validateLinesParallel(const DFA* dfa, const char* data, size_t size, int num_threads,
+                           unsigned char* bitmap, BulkResult* result);
+
+#endif
@@ -0,0 +1,255 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "bulk.h"
+#include "batch.h"
+#include "speculative.h"
+#include "accel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#define BENCH_LINE_LEN 64
+#define MIN_SIZE 1024
+#define SIZE_STEP 32
+// Small inputs are repeated until one timing covers at least this long
+#define MIN_TIMING_SECONDS 0.02
+
+static const char* generator_names[NUM_GENERATORS] = { "uniform", "self-loop", "ping-pong" };
+
+const char* generatorName(InputGenerator gen) {
+    return generator_names[gen];
+}
+
+// xorshift64*: fast, reproducible for a given seed
+static unsigned long long nextRandom(unsigned long long* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+static int stepSymbol(const DFA* dfa, int state, int symbol) {
+    return dfa_next(dfa, state, dfa->class_map[(unsigned char)dfa->symbols[symbol]]);
+}
+
+// Shortest symbol path from the start state to a live state with a
+// self-loop; returns its length (0 if the start state loops itself) and
+// sets *loop_symbol, or -1 if no live state loops
+static int findSelfLoop(const DFA* dfa, int* path, int* loop_symbol) {
+    int n = dfa->num_states;
+    int* parent = malloc((size_t)n * 2 * sizeof(int));
+    int* queue = malloc((size_t)n * sizeof(int));
+    if (!parent || !queue) {
+        perror("Error allocating benchmark search");
+        exit(EXIT_FAILURE);
+    }
+    int* via = parent + n;
+    for (int s = 0; s < n; s++) parent[s] = -2;
+
+    int head = 0, tail = 0, found = -1;
+    parent[dfa->start_state] = -1;
+    queue[tail++] = dfa->start_state;
+    while (head < tail && found < 0) {
+        int s = queue[head++];
+        for (int j = 0; j < dfa->num_symbols; j++) {
+            int t = stepSymbol(dfa, s, j);
+            if (t == s && s != dfa->dead_state) {
+                found = s;
+                *loop_symbol = j;
+                break;
+            }
+            if (parent[t] == -2 && t != dfa->dead_state) {
+                parent[t] = s;
+                via[t] = j;
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    int length = -1;
+    if (found >= 0) {
+        length = 0;
+        for (int s = found; parent[s] >= 0; s = parent[s]) length++;
+        int i = length;
+        for (int s = found; parent[s] >= 0; s = parent[s]) path[--i] = via[s];
+    }
+    free(parent);
+    free(queue);
+    return length;
+}
+
+// Fill buf with synthetic input
+void generateInput(const DFA* dfa, InputGenerator gen, char* buf, size_t size,
+                   size_t line_len, unsigned long long seed) {
+    unsigned long long rng = seed ? seed : 1;
+    int* path = malloc((size_t)dfa->num_states * sizeof(int));
+    if (!path) {
+        perror("Error allocating benchmark path");
+        exit(EXIT_FAILURE);
+    }
+    int loop_symbol = 0;
+    int path_len = gen == GEN_SELF_LOOP ? findSelfLoop(dfa, path, &loop_symbol) : -1;
+    if (gen == GEN_SELF_LOOP && path_len < 0) gen = GEN_PING_PONG;
+
+    int state = dfa->start_state;
+    size_t column = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (line_len > 0 && column == line_len - 1) {
+            buf[i] = '\n';
+            state = dfa->start_state;
+            column = 0;
+            continue;
+        }
+
+        int symbol;
+        if (gen == GEN_UNIFORM) {
+            symbol = (int)(nextRandom(&rng) % (unsigned)dfa->num_symbols);
+        } else if (gen == GEN_SELF_LOOP) {
+            symbol = (int)column < path_len ? path[column] : loop_symbol;
+        } else {
+            // Prefer symbols that move to another live state, picked at random
+            int candidates[256], count = 0;
+            for (int j = 0; j < dfa->num_symbols; j++) {
+                int t = stepSymbol(dfa, state, j);
+                if (t != state && t != dfa->dead_state) candidates[count++] = j;
+            }
+            for (int j = 0; j < dfa->num_symbols && count == 0; j++) {
+                if (stepSymbol(dfa, state, j) != dfa->dead_state) candidates[count++] = j;
+            }
+            symbol = count > 0 ? candidates[nextRandom(&rng) % (unsigned)count]
+                               : (int)(nextRandom(&rng) % (unsigned)dfa->num_symbols);
+        }
+        buf[i] = dfa->symbols[symbol];
+        state = stepSymbol(dfa, state, symbol);
+        column++;
+    }
+    free(path);
+}
+
+// Write text as a quoted CSV field
+static void writeCsvField(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"') fputc('"', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+// Time-stamp counter (rdtsc on x86), 0 where unavailable. TSC ticks run at
+// a fixed reference rate, not the core clock, so they differ from core
+// cycles under turbo or frequency scaling.
+static unsigned long long readTsc(void) {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+typedef enum {
+    ENGINE_ACCEPTS,
+    ENGINE_LINES,
+    ENGINE_PARALLEL,
+    ENGINE_SPECULATIVE,
+    ENGINE_ACCEL,
+    NUM_ENGINES
+} Engine;
+
+static const char* engine_names[NUM_ENGINES] = {
+    "dfa_accepts", "validateLines", "validateLinesParallel", "speculative", "accel_accepts"
+};
+
+// Run engine once over data; returns a result that depends on every byte
+static size_t runEngine(Engine engine, const DFA* dfa, const AccelDFA* accel,
+                        const char* data, size_t size, int num_threads) {
+    BulkResult result;
+    switch (engine) {
+        case ENGINE_ACCEPTS:
+            return dfa_accepts(dfa, data, size);
+        case ENGINE_LINES:
+            validateLines(dfa, data, size, NULL, &result);
+            return result.accepted;
+        case ENGINE_PARALLEL:
+            validateLinesParallel(dfa, data, size, num_threads, NULL, &result);
+            return result.accepted;
+        case ENGINE_SPECULATIVE:
+            return dfa_accepts_speculative(dfa, data, size, num_threads);
+        case ENGINE_ACCEL:
+            return accel_accepts(accel, data, size, NULL);
+        default:
+            return 0;
+    }
+}
+
+// Called through a volatile pointer so the compiler cannot hoist the inline
+// dfa_accepts out of a repetition loop and time an empty loop instead
+static size_t (*volatile run_engine)(Engine, const DFA*, const AccelDFA*,
+                                     const char*, size_t, int) = runEngine;
+
+// Time every engine on every generator and size
+void runBenchmarkSuite(const DFA* dfa, size_t max_size, int num_threads, FILE* out) {
+    char* whole = malloc(max_size);
+    char* lines = malloc(max_size);
+    if (!whole || !lines) {
+        perror("Error allocating benchmark input");
+        exit(EXIT_FAILURE);
+    }
+    AccelDFA accel;
+    initAccelDFA(&accel, dfa);
+
+    fprintf(out, "tool,engine,pattern,generator,bytes,threads,seconds,bytes_per_sec,ns_per_byte,tsc_ticks_per_byte,result\n");
+    for (int g = 0; g < NUM_GENERATORS; g++) {
+        // Generate once at the largest size; smaller runs use a prefix
+        generateInput(dfa, (InputGenerator)g, whole, max_size, 0, 12345 + g);
+        generateInput(dfa, (InputGenerator)g, lines, max_size, BENCH_LINE_LEN, 12345 + g);
+
+        for (size_t size = MIN_SIZE; size <= max_size; size *= SIZE_STEP) {
+            for (int e = 0; e < NUM_ENGINES; e++) {
+                const char* data = (e == ENGINE_LINES || e == ENGINE_PARALLEL) ? lines : whole;
+                int threads = (e == ENGINE_PARALLEL || e == ENGINE_SPECULATIVE) ? num_threads : 1;
+
+                // Calibrate repetitions, then keep the best of 3 timings
+                size_t reps = 1, result = 0;
+                for (;;) {
+                    double start = wallClockSeconds();
+                    for (size_t r = 0; r < reps; r++) result += run_engine(e, dfa, &accel, data, size, threads);
+                    if (wallClockSeconds() - start >= MIN_TIMING_SECONDS || reps >= (1u << 24)) break;
+                    reps *= 2;
+                }
+                double best = 1e30;
+                unsigned long long best_ticks = 0;
+                for (int run = 0; run < 3; run++) {
+                    result = 0;
+                    unsigned long long c0 = readTsc();
+                    double start = wallClockSeconds();
+                    for (size_t r = 0; r < reps; r++) result += run_engine(e, dfa, &accel, data, size, threads);
+                    double elapsed = (wallClockSeconds() - start) / reps;
+                    unsigned long long ticks = (readTsc() - c0) / reps;
+                    if (elapsed < best) {
+                        best = elapsed;
+                        best_ticks = ticks;
+                    }
+                }
+
+                fprintf(out, "validator,%s,", engine_names[e]);
+                writeCsvField(out, dfa->regex);
+                fprintf(out, ",%s,%zu,%d,%.9f,%.0f,%.4f,",
+                        generator_names[g], size, threads, best,
+                        best > 0 ? size / best : 0.0, best * 1e9 / size);
+                if (best_ticks > 0) {
+                    fprintf(out, "%.4f", (double)best_ticks / size);
+                }
+                fprintf(out, ",%zu\n", result / reps);
+                fflush(out);
+            }
+        }
+    }
+
+    freeAccelDFA(&accel);
+    free(whole);
+    free(lines);
+}
@@ -0,0 +1,30 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include "dfa.h"
+
+// Synthetic inputs for throughput measurements
+typedef enum {
+    GEN_UNIFORM,     // random alphabet symbols
+    GEN_SELF_LOOP,   // drive into a live state, then repeat its self-loop symbol
+    GEN_PING_PONG,   // random walk that changes state on every byte
+    NUM_GENERATORS
+} InputGenerator;
+
+// Name used in benchmark output
+const char* generatorName(InputGenerator gen);
+
+// Fill buf with size bytes of gen input for dfa. With line_len > 0 every
+// line_len-th byte is '\n' (the walk restarts at the start state there).
+void generateInput(const DFA* dfa, InputGenerator gen, char* buf, size_t size,
+                   size_t line_len, unsigned long long seed);
+
+// Time every validation path (dfa_accepts, validateLines,
+// validateLinesParallel, speculative, accel_accepts) on every generator at sizes
+// 1 KB, 32 KB, 1 MB, ... up to max_size, writing one CSV row per run:
+//   tool,engine,pattern,generator,bytes,threads,seconds,bytes_per_sec,ns_per_byte,tsc_ticks_per_byte,result
+// tsc_ticks_per_byte is empty where no time-stamp counter is available.
+void runBenchmarkSuite(const DFA* dfa, size_t max_size, int num_threads, FILE* out);
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bulk.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Map a whole file read-only
+bool mapFile(const char* path, MappedFile* file) {
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Error opening input file '%s'\n", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        fprintf(stderr, "Error reading size of '%s'\n", path);
+        CloseHandle(handle);
+        return false;
+    }
+    file->size = (size_t)size.QuadPart;
+    if (file->size > 0) {
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            file->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        if (!file->data) {
+            fprintf(stderr, "Error mapping input file '%s'\n", path);
+            CloseHandle(handle);
+            return false;
+        }
+    }
+    file->handle = handle;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening input file");
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror("Error reading input file size");
+        close(fd);
+        return false;
+    }
+    file->size = (size_t)st.st_size;
+    if (file->size > 0) {
+        void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror("Error mapping input file");
+            close(fd);
+            return false;
+        }
+        posix_madvise(data, file->size, POSIX_MADV_SEQUENTIAL);
+        file->data = data;
+    }
+    close(fd);
+#endif
+    return true;
+}
+
+// Release a mapping created by mapFile
+void unmapFile(MappedFile* file) {
+#ifdef _WIN32
+    if (file->data) UnmapViewOfFile(file->data);
+    if (file->handle) CloseHandle(file->handle);
+#else
+    if (file->data) munmap((void*)file->data, file->size);
+#endif
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+}
+
+// One bit per line; there are at most size + 1 lines
+size_t bitmapSize(size_t size) {
+    return size / 8 + 1;
+}
+
+// Validate each newline-delimited string
+void validateLines(const DFA* dfa, const char* data, size_t size,
+                   unsigned char* bitmap, BulkResult* result) {
+    size_t lines = 0, accepted = 0;
+    const char* p = data;
+    const char* end = data + size;
+
+    while (p < end) {
+        const char* newline = memchr(p, '\n', (size_t)(end - p));
+        const char* line_end = newline ? newline : end;
+        size_t len = (size_t)(line_end - p);
+        if (len > 0 && p[len - 1] == '\r') len--;
+
+        if (dfa_accepts(dfa, p, len)) {
+            accepted++;
+            if (bitmap) bitmap[lines >> 3] |= (unsigned char)(1u << (lines & 7));
+        }
+        lines++;
+        p = newline ? newline + 1 : end;
+    }
+
+    result->lines = lines;
+    result->accepted = accepted;
+    result->rejected = lines - accepted;
+}
+
+// Monotonic wall-clock time in seconds
+double wallClockSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,39 @@
+#ifndef BULK_H
+#define BULK_H
+
+#include <stddef.h>
+#include "dfa.h"
+
+// Read-only memory mapping of an input file
+typedef struct {
+    const char* data;
+    size_t size;
+    void* handle;
+} MappedFile;
+
+// Counts produced by bulk validation
+typedef struct {
+    size_t lines;
+    size_t accepted;
+    size_t rejected;
+} BulkResult;
+
+// Map a whole file read-only; returns false (with perror) on failure
+bool mapFile(const char* path, MappedFile* file);
+
+// Release a mapping created by mapFile
+void unmapFile(MappedFile* file);
+
+// Bytes needed for a one-bit-per-line bitmap of data
+size_t bitmapSize(size_t size);
+
+// Validate each newline-delimited string in data (a trailing '\r' is
+// ignored). If bitmap is not NULL, bit i (LSB first) is set when line i
+// is accepted; it must be bitmapSize(size) bytes and zeroed.
+void validateLines(const DFA* dfa, const char* data, size_t size,
+                   unsigned char* bitmap, BulkResult* result);
+
+// Monotonic wall-clock time in seconds
+double wallClockSeconds(void);
+
+#endif
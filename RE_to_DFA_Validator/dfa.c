@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dfa.h"
+
+// Point dfa's arrays at storage
+void attachStorage(DFA* dfa, DFAStorage* storage) {
+    memset(storage, 0, sizeof(*storage));
+    dfa->symbols = storage->symbols;
+    dfa->class_map = storage->class_map;
+    dfa->table_width = 1;
+    dfa->transition_table = storage->transition_table;
+    dfa->accepting_states = storage->accepting_states;
+    dfa->state_names = storage->state_names;
+    dfa->regex = storage->regex;
+}
+
+// Store one table entry at the DFA's entry width
+static void storeTransition(DFA* dfa, int from, int cls, int to) {
+    size_t i = (size_t)from * dfa->num_classes + cls;
+    switch (dfa->table_width) {
+        case 1: ((uint8_t*)dfa->transition_table)[i] = (uint8_t)to; break;
+        case 2: ((uint16_t*)dfa->transition_table)[i] = (uint16_t)to; break;
+        default: ((int32_t*)dfa->transition_table)[i] = to; break;
+    }
+}
+
+// Build the byte -> class map and add the dead state
+// (call after symbols are set and before transitions are filled in)
+void initByteClasses(DFA* dfa) {
+    dfa->num_classes = dfa->num_symbols + 1;
+    memset(dfa->class_map, dfa->num_symbols, 256);
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        dfa->class_map[(unsigned char)dfa->symbols[i]] = (unsigned char)i;
+    }
+
+    // Dead state: non-accepting, every class loops back to it
+    int dead = dfa->dead_state = dfa->num_states++;
+    snprintf(dfa->state_names[dead], sizeof(dfa->state_names[dead]), "q%d", dead);
+    dfa->accepting_states[dead] = false;
+    for (int s = 0; s < dfa->num_states; s++) {
+        for (int c = 0; c < dfa->num_classes; c++) {
+            storeTransition(dfa, s, c, dead);
+        }
+    }
+}
+
+// Set the transition from state on symbol
+void setTransition(DFA* dfa, int from, char symbol, int to) {
+    int cls = dfa->class_map[(unsigned char)symbol];
+    storeTransition(dfa, from, cls, to);
+}
+
+// Validate string with step-by-step output
+bool validateString(DFA* dfa, const char* str) {
+    int current_state = dfa->start_state;
+    
+    printf("\n  Initial state: %s\n", dfa->state_names[current_state]);
+    printf("  Transitions:\n");
+    
+    for (int i = 0; str[i] != '\0'; i++) {
+        int cls = dfa->class_map[(unsigned char)str[i]];
+        int next_state = dfa_next(dfa, current_state, cls);
+        printf("    %s --(%c)--> %s", 
+               dfa->state_names[current_state], 
+               str[i], 
+               dfa->state_names[next_state]);
+        
+        if (dfa->accepting_states[next_state]) {
+            printf(" [accepting]");
+        } else if (next_state == dfa->dead_state) {
+            printf(" [dead]");
+        }
+        printf("\n");
+        
+        current_state = next_state;
+    }
+    
+    printf("  Final state: %s\n", dfa->state_names[current_state]);
+    bool accepted = dfa->accepting_states[current_state];
+    printf("  Result: %s\n", accepted ? "ACCEPTED" : "REJECTED");
+    
+    return accepted;
+}
+
+// Print transition table
+void printTransitionTable(DFA* dfa) {
+    printf("Transition Table:\n");
+    printf("  +-------+");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("-------+");
+    }
+    printf("\n");
+    
+    printf("  | State |");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("   %c   |", dfa->symbols[i]);
+    }
+    printf("\n");
+    
+    printf("  +-------+");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("-------+");
+    }
+    printf("\n");
+    
+    for (int i = 0; i < dfa->num_states; i++) {
+        if (dfa->accepting_states[i]) {
+            printf("  | *%-4s |", dfa->state_names[i]);
+        } else {
+            printf("  |  %-4s |", dfa->state_names[i]);
+        }
+        
+        for (int j = 0; j < dfa->num_symbols; j++) {
+            int cls = dfa->class_map[(unsigned char)dfa->symbols[j]];
+            int next = dfa_next(dfa, i, cls);
+            if (dfa->accepting_states[next]) {
+                printf(" *%-4s|", dfa->state_names[next]);
+            } else {
+                printf("  %-4s|", dfa->state_names[next]);
+            }
+        }
+        printf("\n");
+    }
+    
+    printf("  +-------+");
+    for (int i = 0; i < dfa->num_symbols; i++) {
+        printf("-------+");
+    }
+    printf("\n");
+    printf("  (* denotes accepting state)\n\n");
+}
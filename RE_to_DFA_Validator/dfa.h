@@ -0,0 +1,121 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_STATES 20
+#define MAX_SYMBOLS 10
+#define MAX_CLASSES (MAX_SYMBOLS + 1)
+#define MAX_TRANSITIONS 100
+#define STATE_NAME_LEN 16
+
+// Structure to represent a DFA
+// Each input byte maps to a class: one per alphabet symbol, plus a final
+// reject class for every other byte that leads to the dead state. The
+// transition table is flat and row-major:
+//     next = transition_table[state * num_classes + class_map[byte]]
+// Entries use the narrowest type that holds every state number:
+// table_width 1 (uint8_t, up to 256 states), 2 (uint16_t, up to 65536)
+// or 4 (int32_t), so a step touches as little cache as possible.
+// The arrays live either in a DFAStorage (DFAs built in code, limited to
+// the MAX_* sizes above) or in a read-only mapped .dfa file (dfafile.h).
+typedef struct {
+    int num_states;
+    int num_symbols;
+    char* symbols;
+    int num_classes;
+    unsigned char* class_map;
+    int table_width;
+    void* transition_table;
+    int start_state;
+    int dead_state;
+    bool* accepting_states;
+    char (*state_names)[STATE_NAME_LEN];
+    char* regex;
+} DFA;
+
+// Backing arrays for a DFA built in code (MAX_STATES <= 256, so the
+// table always has 1-byte entries)
+typedef struct {
+    char symbols[MAX_SYMBOLS];
+    unsigned char class_map[256];
+    uint8_t transition_table[MAX_STATES * MAX_CLASSES];
+    bool accepting_states[MAX_STATES];
+    char state_names[MAX_STATES][STATE_NAME_LEN];
+    char regex[100];
+} DFAStorage;
+
+// Point dfa's arrays at storage (call first when building a DFA in code)
+void attachStorage(DFA* dfa, DFAStorage* storage);
+
+// Build the byte -> class map and add the dead state
+void initByteClasses(DFA* dfa);
+
+// Set the transition from state on symbol
+void setTransition(DFA* dfa, int from, char symbol, int to);
+
+// Transition from state on byte class cls
+static inline int dfa_next(const DFA* dfa, int state, int cls) {
+    size_t i = (size_t)state * dfa->num_classes + cls;
+    switch (dfa->table_width) {
+        case 1: return ((const uint8_t*)dfa->transition_table)[i];
+        case 2: return ((const uint16_t*)dfa->transition_table)[i];
+        default: return ((const int32_t*)dfa->transition_table)[i];
+    }
+}
+
+// Per-width step loops; dfa_run picks one per call, not per byte
+static inline int dfa_run8(const DFA* dfa, int state, const char* str, size_t len) {
+    const unsigned char* class_map = dfa->class_map;
+    const uint8_t* table = dfa->transition_table;
+    int num_classes = dfa->num_classes;
+    for (size_t i = 0; i < len; i++) {
+        state = table[state * num_classes + class_map[(unsigned char)str[i]]];
+    }
+    return state;
+}
+
+static inline int dfa_run16(const DFA* dfa, int state, const char* str, size_t len) {
+    const unsigned char* class_map = dfa->class_map;
+    const uint16_t* table = dfa->transition_table;
+    int num_classes = dfa->num_classes;
+    for (size_t i = 0; i < len; i++) {
+        state = table[state * num_classes + class_map[(unsigned char)str[i]]];
+    }
+    return state;
+}
+
+static inline int dfa_run32(const DFA* dfa, int state, const char* str, size_t len) {
+    const unsigned char* class_map = dfa->class_map;
+    const int32_t* table = dfa->transition_table;
+    int num_classes = dfa->num_classes;
+    for (size_t i = 0; i < len; i++) {
+        state = table[state * num_classes + class_map[(unsigned char)str[i]]];
+    }
+    return state;
+}
+
+// Run len bytes from state and return the state reached
+static inline int dfa_run(const DFA* dfa, int state, const char* str, size_t len) {
+    switch (dfa->table_width) {
+        case 1: return dfa_run8(dfa, state, str, len);
+        case 2: return dfa_run16(dfa, state, str, len);
+        default: return dfa_run32(dfa, state, str, len);
+    }
+}
+
+// Silent acceptance test: one table step per byte, no output.
+// Defined inline so bulk/batch loops can inline it per line.
+static inline bool dfa_accepts(const DFA* dfa, const char* str, size_t len) {
+    return dfa->accepting_states[dfa_run(dfa, dfa->start_state, str, len)];
+}
+
+// Validate string with step-by-step output (opt-in trace of dfa_accepts)
+bool validateString(DFA* dfa, const char* str);
+
+// Print transition table
+void printTransitionTable(DFA* dfa);
+
+#endif
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <string.h>
+#include "dfafile.h"
+
+// Is [offset, offset + size) inside the file and aligned to align?
+static bool sectionFits(const DFAFileHeader* header, uint64_t offset, uint64_t size, uint64_t align) {
+    return offset % align == 0 && offset <= header->file_size && size <= header->file_size - offset;
+}
+
+// Bytes per table entry (version 1 tables are always int32)
+static uint32_t tableWidth(const DFAFileHeader* header) {
+    return header->version == 1 ? sizeof(int32_t) : header->table_width;
+}
+
+// Check that header describes a well-formed file of file_size bytes
+static const char* checkHeader(const DFAFileHeader* header, size_t file_size) {
+    if (file_size < 8 || memcmp(header->magic, DFA_FILE_MAGIC, 8) != 0) return "not a DFA file";
+    if (file_size < sizeof(DFAFileHeader)) return "truncated or corrupt";
+    if (header->endian_check != DFA_FILE_ENDIAN_CHECK) return "written on a machine with a different byte order";
+    if (header->version != 1 && header->version != DFA_FILE_VERSION) return "unsupported version";
+    if (header->header_size != sizeof(DFAFileHeader) || header->file_size != file_size) return "truncated or corrupt";
+    if (header->name_len != STATE_NAME_LEN) return "unsupported state name length";
+
+    uint64_t n = header->num_states;
+    uint64_t k = header->num_classes;
+    uint64_t width = tableWidth(header);
+    if (n == 0 || k == 0 || k > 256 || header->num_symbols > 256) return "bad state or class count";
+    if (width != 1 && width != 2 && width != 4) return "bad table width";
+    if (header->start_state < 0 || (uint64_t)header->start_state >= n) return "bad start state";
+    if (header->dead_state < -1 || header->dead_state >= (int64_t)n) return "bad dead state";
+
+    if (!sectionFits(header, header->regex_offset, 1, 1)
+        || !sectionFits(header, header->symbols_offset, header->num_symbols, 1)
+        || !sectionFits(header, header->class_map_offset, 256, 1)
+        || n > UINT64_MAX / k / width
+        || !sectionFits(header, header->table_offset, n * k * width, width)
+        || !sectionFits(header, header->accept_offset, n, 1)
+        || !sectionFits(header, header->names_offset, n * STATE_NAME_LEN, 1)) {
+        return "section out of bounds";
+    }
+    return NULL;
+}
+
+// Map a .dfa file and use it in place
+bool loadDFA(const char* path, DFA* dfa, MappedFile* file) {
+    // The accept flags are used as bool in place
+    if (sizeof(bool) != 1) {
+        fprintf(stderr, "Error loading '%s': unsupported platform type sizes\n", path);
+        return false;
+    }
+    if (!mapFile(path, file)) {
+        return false;
+    }
+
+    const char* base = file->data;
+    const DFAFileHeader* header = (const DFAFileHeader*)base;
+    const char* problem = checkHeader(header, file->size);
+
+    const char* regex = base + (problem ? 0 : header->regex_offset);
+    if (!problem && !memchr(regex, '\0', file->size - header->regex_offset)) {
+        problem = "unterminated pattern";
+    }
+    if (!problem) {
+        uint64_t count = (uint64_t)header->num_states * header->num_classes;
+        const void* table = base + header->table_offset;
+        uint32_t width = tableWidth(header);
+        const unsigned char* class_map = (const unsigned char*)(base + header->class_map_offset);
+        const unsigned char* accept = (const unsigned char*)(base + header->accept_offset);
+        for (uint64_t i = 0; i < count && !problem; i++) {
+            int64_t target = width == 1 ? ((const uint8_t*)table)[i]
+                           : width == 2 ? ((const uint16_t*)table)[i]
+                           : ((const int32_t*)table)[i];
+            if (target < 0 || target >= header->num_states) problem = "transition out of range";
+        }
+        for (int b = 0; b < 256 && !problem; b++) {
+            if (class_map[b] >= header->num_classes) problem = "class out of range";
+        }
+        const char* names = base + header->names_offset;
+        for (uint32_t s = 0; s < header->num_states && !problem; s++) {
+            if (accept[s] > 1) problem = "bad accept flag";
+            if (names[(size_t)s * STATE_NAME_LEN + STATE_NAME_LEN - 1] != '\0') problem = "unterminated state name";
+        }
+    }
+    if (problem) {
+        fprintf(stderr, "Error loading '%s': %s\n", path, problem);
+        unmapFile(file);
+        return false;
+    }
+
+    // Read-only mapping: the casts only drop const for the shared DFA type
+    dfa->num_states = (int)header->num_states;
+    dfa->num_symbols = (int)header->num_symbols;
+    dfa->symbols = (char*)(base + header->symbols_offset);
+    dfa->num_classes = (int)header->num_classes;
+    dfa->class_map = (unsigned char*)(base + header->class_map_offset);
+    dfa->table_width = (int)tableWidth(header);
+    dfa->transition_table = (void*)(base + header->table_offset);
+    dfa->start_state = header->start_state;
+    dfa->dead_state = header->dead_state;
+    dfa->accepting_states = (bool*)(base + header->accept_offset);
+    dfa->state_names = (char (*)[STATE_NAME_LEN])(base + header->names_offset);
+    dfa->regex = (char*)regex;
+    return true;
+}
@@ -0,0 +1,39 @@
+#include "graph.h"
+#include "../RE_to_DFA_Converter/svglayout.h"
+
+static int graphNext(const void* graph, int state, unsigned char symbol) {
+    const DFA* dfa = graph;
+    return dfa_next(dfa, state, dfa->class_map[symbol]);
+}
+
+static const char* graphStateName(const void* graph, int state) {
+    const DFA* dfa = graph;
+    return dfa->state_names[state];
+}
+
+static StateDiagram dfaDiagram(const DFA* dfa) {
+    StateDiagram diagram = {
+        .graph = dfa,
+        .num_states = dfa->num_states,
+        .start_state = dfa->start_state,
+        .dead_state = dfa->dead_state,
+        .symbols = dfa->symbols,
+        .num_symbols = dfa->num_symbols,
+        .accepting = dfa->accepting_states,
+        .title = dfa->regex,
+        .next = graphNext,
+        .state_name = graphStateName,
+        .state_note = NULL,
+    };
+    return diagram;
+}
+
+void generateDotFile(DFA* dfa, const char* filename) {
+    StateDiagram diagram = dfaDiagram(dfa);
+    writeDotDiagram(&diagram, filename);
+}
+
+void generateSvgFile(DFA* dfa, const char* filename) {
+    StateDiagram diagram = dfaDiagram(dfa);
+    writeSvgDiagram(&diagram, filename);
+}
@@ -0,0 +1,17 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "dfa.h"
+
+// Diagrams of the DFA, drawn by the converter's shared writers
+// (../RE_to_DFA_Converter/diagram.h and svglayout.h). Edges are labelled
+// by diagramEdgeLabel; the dead state and edges into it are omitted.
+
+// Generate Graphviz DOT file (one edge per state pair)
+void generateDotFile(DFA* dfa, const char* filename);
+
+// Draw the DFA as a standalone SVG image, in process (no Graphviz), with
+// the converter's layered layout (writeSvgDiagram)
+void generateSvgFile(DFA* dfa, const char* filename);
+
+#endif
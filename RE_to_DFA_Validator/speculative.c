@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "speculative.h"
+#include "batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_SHUFFLE_KERNEL 1
+#endif
+
+// Below this size a sequential run is faster than splitting
+#define MIN_SPECULATIVE_BYTES (256 * 1024)
+// Scalar kernel: bytes between merges of start states that have converged
+#define MERGE_INTERVAL 64
+
+typedef struct {
+    const DFA* dfa;
+    const char* data;
+    size_t chunk_size;
+    size_t size;
+    int first_state;                      // chunk 0: real final state
+    int* maps;                            // chunks 1..n: start -> end state
+} SpeculativeJob;
+
+// Scalar kernel: run every start state through the chunk, merging start
+// states that have reached the same state so the work shrinks to the
+// number of distinct live states (often 1 after a few bytes). Runs in
+// the dead state are not stepped: it is absorbing.
+static void mapChunkScalar(const DFA* dfa, const char* data, size_t size, int* map) {
+    int n = dfa->num_states;
+    int* work = malloc((size_t)n * 4 * sizeof(int));
+    if (!work) {
+        perror("Error allocating state maps");
+        exit(EXIT_FAILURE);
+    }
+    int* active = work;           // distinct current states
+    int* owner = work + n;        // start state -> index into active
+    int* slot = work + 2 * n;
+    int* remap = work + 3 * n;
+    int num_active = n, num_live = n;
+    for (int s = 0; s < n; s++) {
+        active[s] = s;
+        owner[s] = s;
+    }
+
+    size_t offset = 0;
+    while (offset < size && num_live > 0) {
+        size_t len = num_live == 1 ? size - offset : MERGE_INTERVAL;
+        if (len > size - offset) len = size - offset;
+        for (int a = 0; a < num_active; a++) {
+            if (active[a] != dfa->dead_state) {
+                active[a] = dfa_run(dfa, active[a], data + offset, len);
+            }
+        }
+        offset += len;
+
+        int merged = 0;
+        for (int s = 0; s < n; s++) slot[s] = -1;
+        num_live = 0;
+        for (int a = 0; a < num_active; a++) {
+            if (slot[active[a]] < 0) {
+                slot[active[a]] = merged;
+                active[merged++] = active[a];
+                if (active[a] != dfa->dead_state) num_live++;
+            }
+            remap[a] = slot[active[a]];
+        }
+        for (int s = 0; s < n; s++) owner[s] = remap[owner[s]];
+        num_active = merged;
+    }
+
+    for (int s = 0; s < n; s++) {
+        map[s] = active[owner[s]];
+    }
+    free(work);
+}
+
+#ifdef HAVE_SHUFFLE_KERNEL
+// SSSE3 kernel for num_states <= 16: lane s of v holds the current state
+// of the run that started in s, and one pshufb per byte looks all 16
+// lanes up in that byte's class column of the transition table
+__attribute__((target("ssse3")))
+static void mapChunkShuffle(const DFA* dfa, const char* data, size_t size, int* map) {
+    __m128i columns[256];
+    unsigned char column[16];
+    for (int c = 0; c < dfa->num_classes; c++) {
+        for (int s = 0; s < 16; s++) {
+            column[s] = s < dfa->num_states
+                ? (unsigned char)dfa_next(dfa, s, c)
+                : (unsigned char)s;
+        }
+        columns[c] = _mm_loadu_si128((const __m128i*)column);
+    }
+
+    const unsigned char* class_map = dfa->class_map;
+    const unsigned char* p = (const unsigned char*)data;
+    __m128i v = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (size_t i = 0; i < size; i++) {
+        v = _mm_shuffle_epi8(columns[class_map[p[i]]], v);
+    }
+
+    _mm_storeu_si128((__m128i*)column, v);
+    for (int s = 0; s < dfa->num_states; s++) {
+        map[s] = column[s];
+    }
+}
+
+static bool useShuffleKernel(const DFA* dfa) {
+    return dfa->num_states <= 16 && __builtin_cpu_supports("ssse3");
+}
+#else
+static bool useShuffleKernel(const DFA* dfa) {
+    (void)dfa;
+    return false;
+}
+#endif
+
+// Name of the kernel runSpeculative will use
+const char* speculativeKernel(const DFA* dfa) {
+    return useShuffleKernel(dfa) ? "SSSE3 shuffle" : "scalar";
+}
+
+// Process one chunk: the first from the real start state, the rest from every state
+static void speculativeChunk(void* ctx, int index) {
+    SpeculativeJob* job = ctx;
+    size_t offset = (size_t)index * job->chunk_size;
+    if (offset > job->size) offset = job->size;
+    size_t len = job->size - offset < job->chunk_size ? job->size - offset : job->chunk_size;
+    const char* chunk = job->data + offset;
+
+    if (index == 0) {
+        job->first_state = dfa_run(job->dfa, job->dfa->start_state, chunk, len);
+        return;
+    }
+#ifdef HAVE_SHUFFLE_KERNEL
+    if (useShuffleKernel(job->dfa)) {
+        mapChunkShuffle(job->dfa, chunk, len, job->maps + (size_t)index * job->dfa->num_states);
+        return;
+    }
+#endif
+    mapChunkScalar(job->dfa, chunk, len, job->maps + (size_t)index * job->dfa->num_states);
+}
+
+// Final state after running the whole input
+int runSpeculative(const DFA* dfa, const char* data, size_t size, int num_threads) {
+    if (num_threads < 2 || size < MIN_SPECULATIVE_BYTES) {
+        return dfa_run(dfa, dfa->start_state, data, size);
+    }
+
+    int num_chunks = num_threads;
+    SpeculativeJob job;
+    job.dfa = dfa;
+    job.data = data;
+    job.size = size;
+    job.chunk_size = (size + num_chunks - 1) / num_chunks;
+    job.first_state = dfa->start_state;
+    job.maps = malloc((size_t)num_chunks * dfa->num_states * sizeof(int));
+    if (!job.maps) {
+        perror("Error allocating state maps");
+        exit(EXIT_FAILURE);
+    }
+
+    parallelFor(num_chunks, num_threads, speculativeChunk, &job);
+
+    // Compose the mappings in input order
+    int state = job.first_state;
+    for (int c = 1; c < num_chunks; c++) {
+        state = job.maps[(size_t)c * dfa->num_states + state];
+    }
+
+    free(job.maps);
+    return state;
+}
+
+// Whole-input acceptance test
+bool dfa_accepts_speculative(const DFA* dfa, const char* data, size_t size, int num_threads) {
+    return dfa->accepting_states[runSpeculative(dfa, data, size, num_threads)];
+}
@@ -0,0 +1,22 @@
+#ifndef SPECULATIVE_H
+#define SPECULATIVE_H
+
+#include <stddef.h>
+#include "dfa.h"
+
+// Speculative data-parallel run of the DFA over one large input. The
+// input is split into chunks; every chunk but the first is run from all
+// states at once, producing a state-mapping vector (start -> end state).
+// The vectors are then composed in input order, so the final state is
+// exactly the one a sequential dfa_run from the start state reaches.
+// With num_states <= 16 and SSSE3 available, each byte steps all start
+// states with a single byte shuffle; otherwise a scalar loop is used.
+int runSpeculative(const DFA* dfa, const char* data, size_t size, int num_threads);
+
+// Whole-input acceptance test built on runSpeculative
+bool dfa_accepts_speculative(const DFA* dfa, const char* data, size_t size, int num_threads);
+
+// Name of the chunk-mapping kernel runSpeculative will use for dfa
+const char* speculativeKernel(const DFA* dfa);
+
+#endif